@@ -0,0 +1,377 @@
+#include <cstdio>
+#include <cstdlib>
+
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "assignment.h"
+#include "metrics.h"
+#include "move_generator.h"
+#include "player_score_engine.h"
+#include "random.h"
+#include "random_optimizer.h"
+#include "schedule.h"
+#include "score.h"
+#include "seat_optimizer.h"
+#include "seat_score_engine.h"
+#include "stop_condition.h"
+
+// --------------------------------------------------------------------------
+// microbenchmarks of scoring and move primitives.
+// Every benchmark runs on a grid of configurations and prints a line per
+// configuration: CSV (default) or JSON lines, so results of releases can be compared.
+// --------------------------------------------------------------------------
+
+// command line options
+struct Options
+{
+    bool json;
+
+    // minimal measured time of a benchmark in seconds
+    double min_time;
+
+    // only benchmarks which contain this substring
+    std::string filter;
+
+    // configurations with at most this number of players
+    size_t max_players;
+
+    // players in every game, players of the grid are scaled to keep the number of tables
+    size_t num_seats;
+};
+
+// tournament of the grid
+struct GridEntry
+{
+    size_t players;
+    size_t rounds;
+    size_t tables;
+};
+
+// every player plays 10 games
+const GridEntry GRID[] = {
+    { 20, 10, 2 },
+    { 50, 10, 5 },
+    { 100, 10, 10 },
+    { 200, 10, 20 },
+    { 500, 10, 50 },
+    { 1000, 10, 100 },
+};
+
+// results go here, so the compiler can not drop measured work
+volatile double g_sink = 0.0;
+
+// runs ops(n) with growing n until it takes the minimal time,
+// returns seconds of the last run and its number of operations
+template <typename Ops>
+double measure(Ops ops, double min_time, size_t* out_num_ops)
+{
+    size_t num_ops = 1;
+    while (true) {
+        auto start = std::chrono::steady_clock::now();
+        ops(num_ops);
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        double seconds = elapsed.count();
+        if (seconds >= min_time || num_ops >= (size_t(1) << 40)) {
+            *out_num_ops = num_ops;
+            return seconds;
+        }
+
+        // aim at the minimal time with a margin, at most 10x at once
+        double scale = (seconds > 0.0) ? 1.2 * min_time / seconds : 10.0;
+        scale = (scale > 10.0) ? 10.0 : (scale < 2.0 ? 2.0 : scale);
+        num_ops = static_cast<size_t>(num_ops * scale);
+    }
+}
+
+void printResult(const Options& options, const char* name, const Configuration& conf,
+    size_t num_ops, double seconds)
+{
+    double ns_per_op = seconds * 1e9 / num_ops;
+    double ops_per_sec = num_ops / seconds;
+    if (options.json) {
+        printf("{\"benchmark\": \"%s\", \"players\": %zu, \"rounds\": %zu, \"tables\": %zu, "
+            "\"ops\": %zu, \"seconds\": %.6f, \"ns_per_op\": %.2f, \"ops_per_sec\": %.1f}\n",
+            name, conf.numPlayers(), conf.numRounds(), conf.numTables(), num_ops, seconds, ns_per_op, ops_per_sec);
+    }
+    else {
+        printf("%s,%zu,%zu,%zu,%zu,%.6f,%.2f,%.1f\n",
+            name, conf.numPlayers(), conf.numRounds(), conf.numTables(), num_ops, seconds, ns_per_op, ops_per_sec);
+    }
+    fflush(stdout);
+}
+
+template <typename Ops>
+void run(const Options& options, const char* name, const Configuration& conf, Ops ops)
+{
+    if (!options.filter.empty() && std::string(name).find(options.filter) == std::string::npos) {
+        return;
+    }
+
+    size_t num_ops = 0;
+    double seconds = measure(ops, options.min_time, &num_ops);
+    printResult(options, name, conf, num_ops, seconds);
+}
+
+// player switches recorded in advance, so replaying them does not generate switches
+struct Switch
+{
+    player_t player_a;
+    size_t game_a;
+    player_t player_b;
+    size_t game_b;
+};
+
+// applied: every switch is made on a copy of the schedule before the next one is generated,
+// otherwise all switches are valid for the schedule itself
+std::vector<Switch> recordSwitches(const Schedule& schedule, size_t num_switches, bool applied, Random& random)
+{
+    Schedule scratch(schedule);
+    std::vector<Switch> switches;
+    while (switches.size() < num_switches) {
+        size_t round = scratch.generateRandomRound(random);
+        size_t game_a = 0;
+        size_t game_b = 0;
+        scratch.generateRandomGames(random, round, &game_a, &game_b);
+
+        Switch s = { 0, game_a, 0, game_b };
+        if (scratch.generateRandomSwitch(random, game_a, game_b, &s.player_a, &s.player_b)) {
+            if (applied) {
+                scratch.switchPlayers(s.player_a, s.game_a, s.player_b, s.game_b);
+            }
+            switches.push_back(s);
+        }
+    }
+    return switches;
+}
+
+void runBenchmarks(const Options& options, const Configuration& conf)
+{
+    auto schedule = Schedule::createInitialSchedule(conf, 0);
+    Random random(1);
+    StopCondition stop(0.0, 0);
+
+    // full scores: histograms are built from scratch, as on every call without a cache
+    run(options, "player_score", conf, [&](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Metrics metrics(*schedule);
+            g_sink = g_sink + calcPlayerScore(metrics);
+        }
+    });
+
+    run(options, "seat_score", conf, [&](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Metrics metrics(*schedule);
+            g_sink = g_sink + calcSeatScore(metrics);
+        }
+    });
+
+    // per player histograms of opponents and seats for all players
+    run(options, "metrics_histograms", conf, [&](size_t n) {
+        Metrics metrics(*schedule);
+        for (size_t i = 0; i < n; i++) {
+            for (player_t player = 0; player < conf.numPlayers(); player++) {
+                g_sink = g_sink + metrics.calcPlayerOpponentsHistogram(player)[0]
+                    + metrics.calcPlayerSeatsHistogram(player)[0];
+            }
+        }
+    });
+
+    run(options, "schedule_copy", conf, [&](size_t n) {
+        Schedule copy(*schedule);
+        for (size_t i = 0; i < n; i++) {
+            copy = *schedule;
+            g_sink = g_sink + static_cast<double>(copy.hash() & 1);
+        }
+    });
+
+    // one operation is one switch, switches are replayed in cycles
+    const size_t NUM_RECORDED = 4096;
+    auto switches = recordSwitches(*schedule, NUM_RECORDED, true, random);
+    run(options, "switch_players", conf, [&](size_t n) {
+        Schedule copy(*schedule);
+        for (size_t i = 0; i < n; i++) {
+            size_t idx = i % NUM_RECORDED;
+            if (idx == 0) {
+                copy = *schedule;
+            }
+            const auto& s = switches[idx];
+            copy.switchPlayers(s.player_a, s.game_a, s.player_b, s.game_b);
+        }
+        g_sink = g_sink + static_cast<double>(copy.hash() & 1);
+    });
+
+    std::vector<size_t> seat_games(NUM_RECORDED);
+    std::vector<size_t> seat_ones(NUM_RECORDED);
+    std::vector<size_t> seat_twos(NUM_RECORDED);
+    for (size_t i = 0; i < NUM_RECORDED; i++) {
+        seat_games[i] = schedule->generateRandomGame(random);
+        seat_ones[i] = schedule->generateRandomSeat(random);
+        seat_twos[i] = schedule->generateRandomSeat(random);
+    }
+    run(options, "switch_seats", conf, [&](size_t n) {
+        Schedule copy(*schedule);
+        for (size_t i = 0; i < n; i++) {
+            size_t idx = i % NUM_RECORDED;
+            copy.switchSeats(seat_games[idx], seat_ones[idx], seat_twos[idx]);
+        }
+        g_sink = g_sink + static_cast<double>(copy.hash() & 1);
+    });
+
+    // incremental deltas evaluated by the optimizers on every probe
+    auto probes = recordSwitches(*schedule, NUM_RECORDED, false, random);
+    run(options, "player_delta", conf, [&](size_t n) {
+        Schedule copy(*schedule);
+        PlayerScoreEngine engine(copy);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            const auto& s = probes[i % NUM_RECORDED];
+            sum += engine.calcSwitchPlayersDelta(s.player_a, s.game_a, s.player_b, s.game_b);
+        }
+        g_sink = g_sink + sum;
+    });
+
+    run(options, "seat_delta", conf, [&](size_t n) {
+        Schedule copy(*schedule);
+        SeatScoreEngine engine(copy);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            size_t idx = i % NUM_RECORDED;
+            if (seat_ones[idx] != seat_twos[idx]) {
+                sum += engine.calcSwitchSeatsDelta(seat_games[idx], seat_ones[idx], seat_twos[idx]);
+            }
+        }
+        g_sink = g_sink + sum;
+    });
+
+    // full optimizer iterations: a probe, its delta and an accepted move now and then.
+    // The optimizers set up their engines once per run, so runs are long
+    run(options, "random_optimizer_iteration", conf, [&](size_t n) {
+        Schedule copy(*schedule);
+        RandomOptimizer optimizer(copy, n, MoveWeights::swaps(), 1, stop, nullptr, nullptr);
+        g_sink = g_sink + optimizer.optimize();
+    });
+
+    // one operation is a run of sweeps until no game improves
+    run(options, "seat_optimizer_run", conf, [&](size_t n) {
+        for (size_t i = 0; i < n; i++) {
+            Schedule copy(*schedule);
+            SeatOptimizer optimizer(copy, conf.numGames() * 1000, 1, i + 1, stop, nullptr);
+            g_sink = g_sink + optimizer.optimize();
+        }
+    });
+
+    // exact seating of a game, costs are seat histograms of its players
+    dispatchSeats(conf.numSeats(), [&](auto seats) {
+        const size_t N = decltype(seats)::value;
+        std::vector<std::array<int, N * N>> costs(conf.numGames());
+        {
+            SeatScoreEngine engine(*schedule);
+            for (size_t game = 0; game < conf.numGames(); game++) {
+                for (size_t from = 0; from < N; from++) {
+                    player_t player = schedule->games()[game].getPlayerAtSeat(static_cast<seat_t>(from));
+                    for (size_t seat = 0; seat < N; seat++) {
+                        costs[game][from * N + seat] = engine.seats(player, static_cast<seat_t>(seat));
+                    }
+                }
+            }
+        }
+        run(options, "seat_assignment", conf, [&](size_t n) {
+            int cost[N][N];
+            size_t column[N];
+            int sum = 0;
+            for (size_t i = 0; i < n; i++) {
+                const auto& game_costs = costs[i % costs.size()];
+                for (size_t from = 0; from < N; from++) {
+                    for (size_t seat = 0; seat < N; seat++) {
+                        cost[from][seat] = game_costs[from * N + seat];
+                    }
+                }
+                sum += solveAssignment(cost, column);
+            }
+            g_sink = g_sink + sum;
+        });
+    });
+}
+
+void usage()
+{
+    printf("Usage: MafBenchmark [options]\n");
+    printf("Options:\n");
+    printf("  --json                JSON lines instead of CSV\n");
+    printf("  --min-time <number>   minimal measured seconds of every benchmark (default 0.2)\n");
+    printf("  --filter <name>       run only benchmarks whose names contain the text\n");
+    printf("  --max-players <number> skip configurations with more players (default 1000)\n");
+    printf("  --seats <number>      players in every game: 8, 10 (default) or 12\n");
+}
+
+bool parseOptions(int argc, char** argv, Options* out_options)
+{
+    out_options->json = false;
+    out_options->min_time = 0.2;
+    out_options->filter.clear();
+    out_options->max_players = 1000;
+    out_options->num_seats = Configuration::DefaultSeats;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--json") {
+            out_options->json = true;
+        }
+        else if (arg == "--min-time" && has_value) {
+            out_options->min_time = strtod(argv[++i], nullptr);
+            if (out_options->min_time <= 0)
+                return false;
+        }
+        else if (arg == "--filter" && has_value) {
+            out_options->filter = argv[++i];
+        }
+        else if (arg == "--max-players" && has_value) {
+            out_options->max_players = strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--seats" && has_value) {
+            out_options->num_seats = strtoul(argv[++i], nullptr, 10);
+            if (!Configuration::isSupportedSeats(out_options->num_seats))
+                return false;
+        }
+        else {
+            printf("Unknown option: %s\n", arg.c_str());
+            return false;
+        }
+    }
+
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    Options options;
+    if (!parseOptions(argc, argv, &options)) {
+        usage();
+        return -1;
+    }
+
+    if (!options.json) {
+        printf("benchmark,players,rounds,tables,ops,seconds,ns_per_op,ops_per_sec\n");
+    }
+
+    for (const auto& entry : GRID) {
+        size_t players = entry.players * options.num_seats / Configuration::DefaultSeats;
+        if (players > options.max_players) {
+            continue;
+        }
+
+        size_t games = entry.rounds * entry.tables;
+        size_t attempts = options.num_seats * games / players;
+        Configuration conf(players, entry.rounds, entry.tables, games, attempts, options.num_seats);
+        runBenchmarks(options, conf);
+    }
+
+    return 0;
+}
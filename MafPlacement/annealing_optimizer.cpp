@@ -0,0 +1,193 @@
+#include "annealing_optimizer.h"
+
+#include <cmath>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+
+#include "moves.h"
+
+// the cooling schedule is saved to a checkpoint as raw bytes
+static_assert(std::is_trivially_copyable<CoolingSchedule>::value, "CoolingSchedule must be trivially copyable");
+
+double AnnealingOptimizer::optimize()
+{
+    // moves evaluate the score of the schedule, so it is restored first
+    const StageCheckpoint* resume = _checkpoint ? _checkpoint->resumeState() : nullptr;
+    if (resume) {
+        _schedule.assignSeats(resume->seats);
+        _random.loadState(resume->random_state);
+    }
+
+    // the classic swaps are generated directly, a mix goes through MoveGenerator
+    if (_target == Target::Players && _weights.isSwapsOnly()) {
+        SwapMoves moves(_schedule, _random, _weights);
+        return anneal(moves);
+    }
+
+    if (_target == Target::Players) {
+        PlayerMoves moves(_schedule, _random, _weights);
+        return anneal(moves);
+    }
+
+    if (_target == Target::Joint) {
+        JointMoves moves(_schedule, _random, _weights, _seat_weight);
+        return anneal(moves);
+    }
+
+    SeatMoves moves(_schedule, _random);
+    return anneal(moves);
+}
+
+template <typename Moves>
+double AnnealingOptimizer::calibrate(Moves& moves)
+{
+    // A constructed schedule has few small uphill moves among large ones
+    // (a pair that stops meeting), scaling by the average would destroy it
+    const size_t NUM_SAMPLES = 10 * 1000;
+    double smallest_uphill = 0.0;
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        if (moves.generate()) {
+            double delta = moves.delta();
+            if (delta > 0 && (smallest_uphill == 0.0 || delta < smallest_uphill)) {
+                smallest_uphill = delta;
+            }
+        }
+    }
+
+    return (smallest_uphill == 0.0) ? 1.0 : smallest_uphill;
+}
+
+template <typename Moves>
+double AnnealingOptimizer::anneal(Moves& moves)
+{
+    _total_iterations = 0;
+    _good_iterations = 0;
+
+    CoolingSchedule cooling(_params, 1.0, _max_iterations);
+
+    // the best schedule is copied only when we are about to leave it uphill
+    double best_score = moves.score();
+    bool at_best = true;
+    std::unique_ptr<Schedule> best_schedule;
+    size_t best_iteration = 0;
+    size_t first_iteration = 0;
+
+    const StageCheckpoint* resume = _checkpoint ? _checkpoint->resumeState() : nullptr;
+    if (resume) {
+        if (resume->optimizer_state.size() != sizeof(cooling)) {
+            throw std::invalid_argument("Checkpoint has no state of annealing.");
+        }
+        memcpy(&cooling, resume->optimizer_state.data(), sizeof(cooling));
+        best_score = resume->best_score;
+        at_best = resume->best_seats.empty();
+        if (!at_best) {
+            best_schedule = std::make_unique<Schedule>(_schedule.config(), resume->best_seats);
+        }
+        best_iteration = static_cast<size_t>(resume->best_iteration);
+        first_iteration = static_cast<size_t>(resume->iteration);
+        _total_iterations = static_cast<size_t>(resume->total_iterations);
+        _good_iterations = static_cast<size_t>(resume->good_iterations);
+    }
+    else {
+        cooling = CoolingSchedule(_params, calibrate(moves), _max_iterations);
+    }
+
+    // copies the state before the iteration, buffers of the slot are reused
+    auto publish = [&](size_t iteration, bool wait) {
+        _checkpoint->publish([&](StageCheckpoint* state) {
+            state->seats = _schedule.seats();
+            if (at_best)
+                state->best_seats.clear();
+            else
+                state->best_seats = best_schedule->seats();
+            state->best_score = best_score;
+            state->iteration = iteration;
+            state->best_iteration = best_iteration;
+            state->total_iterations = _total_iterations;
+            state->good_iterations = _good_iterations;
+            _random.saveState(state->random_state);
+            const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&cooling);
+            state->optimizer_state.assign(bytes, bytes + sizeof(cooling));
+        }, wait);
+    };
+
+    TelemetryCounters counters = {};
+    auto sample = [&](size_t iteration) {
+        _telemetry->sample(iteration, counters, moves.score(), best_score, moves.sdPenalty(), moves.addPenalty());
+    };
+
+    // a schedule may start at the lower bound already
+    _stop.reportScore(best_score);
+
+    size_t i = first_iteration;
+    for (; i < _max_iterations; i++) {
+        if (_stop.shouldStop(i, i - best_iteration)) {
+            if (_checkpoint) {
+                publish(i, true);
+            }
+            break;
+        }
+
+        if (_checkpoint && _checkpoint->isRequested()) {
+            publish(i, false);
+        }
+        if (_telemetry && _telemetry->isDue(i)) {
+            sample(i);
+        }
+        _total_iterations++;
+        counters.probes++;
+
+        ProbeTimer timer(counters, _telemetry && StageTelemetry::isTimed(i));
+        if (!moves.generate()) {
+            counters.failed++;
+            cooling.update(false, false, false);
+            continue;
+        }
+        timer.lap(ProbeTimer::Part::Move);
+
+        // Metropolis acceptance
+        double delta = moves.delta();
+        timer.lap(ProbeTimer::Part::Score);
+        bool uphill = delta > 0;
+        bool accepted = !uphill || _random.generateProbability() < std::exp(-delta / cooling.temperature());
+        bool new_best = false;
+        if (accepted) {
+            if (uphill && at_best) {
+                if (best_schedule)
+                    *best_schedule = _schedule;
+                else
+                    best_schedule = std::make_unique<Schedule>(_schedule);
+                at_best = false;
+            }
+
+            moves.apply();
+            timer.lap(ProbeTimer::Part::Move);
+            _good_iterations++;
+            counters.accepted++;
+
+            double score = moves.score();
+            if (score < best_score) {
+                best_score = score;
+                at_best = true;
+                new_best = true;
+                best_iteration = i;
+                _stop.reportScore(best_score);
+            }
+        }
+
+        cooling.update(uphill, accepted, new_best);
+    }
+
+    if (_telemetry) {
+        sample(i);
+    }
+
+    // restore the best schedule
+    if (!at_best) {
+        _schedule = *best_schedule;
+    }
+
+    return best_score;
+}
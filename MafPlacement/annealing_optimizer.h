@@ -0,0 +1,89 @@
+#pragma once
+
+#include "checkpoint_writer.h"
+#include "cooling_schedule.h"
+#include "moves.h"
+#include "random.h"
+#include "schedule.h"
+#include "stop_condition.h"
+#include "telemetry.h"
+
+//
+// class AnnealingOptimizer - optimizes players' opponents, players' seats
+// or both of them at once (see JointMoves) with simulated annealing. Uphill moves are accepted with Metropolis
+// probability exp(-delta / T), temperature follows the cooling schedule.
+// The best schedule found during the run is left in place,
+// also when the run is stopped early (see StopCondition).
+// With a checkpoint slot the state of the run is published on request
+// and the run continues from a published state after a restart.
+// With telemetry the counters of probes and the score are sampled to the trace.
+//
+class AnnealingOptimizer
+{
+public:
+    typedef MoveTarget Target;
+
+public:
+    AnnealingOptimizer(
+        Schedule& schedule,
+        size_t max_iterations,
+        Target target,
+        const CoolingParams& params,
+        const MoveWeights& weights,
+        double seat_weight,
+        uint64_t seed,
+        const StopCondition& stop,
+        CheckpointSlot* checkpoint,
+        StageTelemetry* telemetry)
+        : _schedule(schedule)
+        , _max_iterations(max_iterations)
+        , _target(target)
+        , _params(params)
+        , _weights(weights)
+        , _seat_weight(seat_weight)
+        , _random(seed)
+        , _stop(stop)
+        , _checkpoint(checkpoint)
+        , _telemetry(telemetry)
+        , _total_iterations(0)
+        , _good_iterations(0)
+    {}
+
+public:
+    double optimize();
+
+    size_t totalIterations() const
+    {
+        return _total_iterations;
+    }
+
+    size_t goodIterations() const
+    {
+        return _good_iterations;
+    }
+
+private:
+    template <typename Moves>
+    double anneal(Moves& moves);
+
+    // the smallest uphill delta of sampled moves, scales temperatures
+    template <typename Moves>
+    double calibrate(Moves& moves);
+
+private:
+    Schedule& _schedule;
+    size_t _max_iterations;
+    Target _target;
+    CoolingParams _params;
+    MoveWeights _weights;
+
+    // weight of the seat score in the objective of joint moves
+    double _seat_weight;
+    Random _random;
+    const StopCondition& _stop;
+    CheckpointSlot* _checkpoint;
+    StageTelemetry* _telemetry;
+
+    size_t _total_iterations;
+    size_t _good_iterations;
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <climits>
+#include <cstddef>
+
+// --------------------------------------------------------------------------
+// min-cost assignment of N rows to N columns (Hungarian method with potentials, O(N^3)).
+// N is a template parameter, so all buffers live on the stack and loops
+// have fixed bounds, e.g. seats of a game: N = Configuration::numSeats() (see dispatchSeats).
+// --------------------------------------------------------------------------
+
+// fills the column of every row, returns the total cost of the assignment.
+// Costs must be small enough that their sum over N rows does not overflow int
+template <size_t N>
+int solveAssignment(const int (&cost)[N][N], size_t (&out_column)[N])
+{
+    // one-based: row 0 and column 0 are the virtual start of augmenting paths
+    int u[N + 1] = {};
+    int v[N + 1] = {};
+    size_t row_of[N + 1] = {};
+    size_t way[N + 1] = {};
+
+    for (size_t row = 1; row <= N; row++) {
+        int min_slack[N + 1];
+        bool used[N + 1];
+        for (size_t col = 0; col <= N; col++) {
+            min_slack[col] = INT_MAX;
+            used[col] = false;
+        }
+
+        // grow the tree of tight edges from the free row until it reaches a free column
+        row_of[0] = row;
+        size_t col0 = 0;
+        do {
+            used[col0] = true;
+            size_t row0 = row_of[col0];
+            int delta = INT_MAX;
+            size_t col1 = 0;
+            for (size_t col = 1; col <= N; col++) {
+                if (used[col])
+                    continue;
+
+                int slack = cost[row0 - 1][col - 1] - u[row0] - v[col];
+                if (slack < min_slack[col]) {
+                    min_slack[col] = slack;
+                    way[col] = col0;
+                }
+                if (min_slack[col] < delta) {
+                    delta = min_slack[col];
+                    col1 = col;
+                }
+            }
+
+            for (size_t col = 0; col <= N; col++) {
+                if (used[col]) {
+                    u[row_of[col]] += delta;
+                    v[col] -= delta;
+                }
+                else {
+                    min_slack[col] -= delta;
+                }
+            }
+            col0 = col1;
+        } while (row_of[col0] != 0);
+
+        // flip the augmenting path
+        do {
+            size_t col1 = way[col0];
+            row_of[col0] = row_of[col1];
+            col0 = col1;
+        } while (col0 != 0);
+    }
+
+    int total = 0;
+    for (size_t col = 1; col <= N; col++) {
+        out_column[row_of[col] - 1] = col - 1;
+        total += cost[row_of[col] - 1][col - 1];
+    }
+    return total;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <cfloat>
+
+//
+// class BestScoreTracker - lock-free tracker of the best and the worst score
+// reported concurrently by worker threads
+//
+class BestScoreTracker
+{
+public:
+    BestScoreTracker()
+        : _best(FLT_MAX)
+        , _worst(-FLT_MAX)
+    {}
+
+    ~BestScoreTracker() = default;
+
+public:
+    double best() const
+    {
+        return _best.load();
+    }
+
+    double worst() const
+    {
+        return _worst.load();
+    }
+
+    // returns false if no score has been reported to the worst one
+    bool hasWorst() const
+    {
+        return _worst.load() != -FLT_MAX;
+    }
+
+    // returns false if the score is worse than the best score reported so far
+    bool update(double score)
+    {
+        double worst = _worst.load();
+        while (score > worst && !_worst.compare_exchange_weak(worst, score)) {
+            // retry
+        }
+
+        return updateBest(score);
+    }
+
+    // the same as update(), but the score is not a candidate for the worst one
+    bool updateBest(double score)
+    {
+        double best = _best.load();
+        while (score < best && !_best.compare_exchange_weak(best, score)) {
+            // retry
+        }
+
+        return score <= best;
+    }
+
+private:
+    std::atomic<double> _best;
+    std::atomic<double> _worst;
+};
@@ -0,0 +1,275 @@
+#include "checkpoint.h"
+
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#include "platform.h"
+
+namespace {
+
+const char MAGIC[8] = { 'M', 'A', 'F', 'C', 'K', 'P', 'T', 0 };
+const uint32_t VERSION = 4;
+
+// FNV-1a of the state, detects truncated and damaged files
+uint64_t calcChecksum(const std::vector<uint8_t>& data, size_t offset)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = offset; i < data.size(); i++) {
+        hash = (hash ^ data[i]) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+// appends plain values and arrays to a buffer
+class Writer
+{
+public:
+    template <typename T>
+    void put(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are written");
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+        _data.insert(_data.end(), bytes, bytes + sizeof(T));
+    }
+
+    template <typename T>
+    void putVector(const std::vector<T>& values)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values are written");
+        put(static_cast<uint64_t>(values.size()));
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(values.data());
+        _data.insert(_data.end(), bytes, bytes + values.size() * sizeof(T));
+    }
+
+    std::vector<uint8_t>& data()
+    {
+        return _data;
+    }
+
+private:
+    std::vector<uint8_t> _data;
+};
+
+// reads values written by Writer, throws at the end of the buffer
+class Reader
+{
+public:
+    Reader(const std::vector<uint8_t>& data, size_t offset)
+        : _data(data)
+        , _offset(offset)
+    {}
+
+    template <typename T>
+    T get()
+    {
+        T value;
+        read(&value, sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::vector<T> getVector()
+    {
+        uint64_t size = get<uint64_t>();
+        if (size > (_data.size() - _offset) / sizeof(T)) {
+            throw std::invalid_argument("Checkpoint is truncated.");
+        }
+
+        std::vector<T> values(static_cast<size_t>(size));
+        read(values.data(), values.size() * sizeof(T));
+        return values;
+    }
+
+    size_t offset() const
+    {
+        return _offset;
+    }
+
+private:
+    void read(void* out, size_t size)
+    {
+        if (size > _data.size() - _offset) {
+            throw std::invalid_argument("Checkpoint is truncated.");
+        }
+
+        if (size != 0) {
+            memcpy(out, &_data[_offset], size);
+        }
+        _offset += size;
+    }
+
+private:
+    const std::vector<uint8_t>& _data;
+    size_t _offset;
+};
+
+void writeStage(Writer& writer, const StageCheckpoint& stage)
+{
+    writer.put(stage.status);
+    writer.putVector(stage.seats);
+    writer.putVector(stage.best_seats);
+    writer.put(stage.best_score);
+    writer.put(stage.iteration);
+    writer.put(stage.best_iteration);
+    writer.put(stage.total_iterations);
+    writer.put(stage.good_iterations);
+    writer.put(stage.random_state);
+    writer.putVector(stage.optimizer_state);
+}
+
+StageCheckpoint readStage(Reader& reader)
+{
+    StageCheckpoint stage;
+    stage.status = reader.get<StageCheckpoint::Status>();
+    stage.seats = reader.getVector<player_t>();
+    stage.best_seats = reader.getVector<player_t>();
+    stage.best_score = reader.get<double>();
+    stage.iteration = reader.get<uint64_t>();
+    stage.best_iteration = reader.get<uint64_t>();
+    stage.total_iterations = reader.get<uint64_t>();
+    stage.good_iterations = reader.get<uint64_t>();
+    for (auto& word : stage.random_state) {
+        word = reader.get<uint64_t>();
+    }
+    stage.optimizer_state = reader.getVector<uint8_t>();
+    return stage;
+}
+
+} // namespace
+
+void Checkpoint::save(const std::string& path) const
+{
+    Writer writer;
+    writer.put(MAGIC);
+    writer.put(VERSION);
+    writer.put(static_cast<uint64_t>(0));   // checksum, set below
+    size_t state_offset = writer.data().size();
+
+    writer.put(num_players);
+    writer.put(num_rounds);
+    writer.put(num_tables);
+    writer.put(num_games);
+    writer.put(num_attempts);
+    writer.put(num_seats);
+    writer.put(seed);
+    writer.put(method);
+    writer.put(moves);
+    writer.put(seat_weight);
+    writer.putVector(start_seats);
+    writer.put(phase);
+    writer.putVector(players_seats);
+    writer.put(first_stage);
+    writer.putVector(best_seats);
+    writer.put(best_score);
+    writer.put(worst_score);
+    writer.put(best_order);
+    writer.put(static_cast<uint64_t>(stages.size()));
+    for (const auto& stage : stages) {
+        writeStage(writer, stage);
+    }
+
+    auto& data = writer.data();
+    uint64_t checksum = calcChecksum(data, state_offset);
+    memcpy(&data[state_offset - sizeof(checksum)], &checksum, sizeof(checksum));
+
+    std::string temp_path = path + ".tmp";
+    FILE* file = nullptr;
+    if (fopen_s(&file, temp_path.c_str(), "wb") != 0 || !file) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not create checkpoint file: %s", temp_path.c_str());
+        throw std::runtime_error(msg);
+    }
+
+    bool written = fwrite(data.data(), 1, data.size(), file) == data.size();
+    written = (fclose(file) == 0) && written;
+    if (!written) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not write checkpoint file: %s", temp_path.c_str());
+        throw std::runtime_error(msg);
+    }
+
+    // rename does not replace an existing file on Windows
+    remove(path.c_str());
+    if (rename(temp_path.c_str(), path.c_str()) != 0) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not rename checkpoint file %s to %s", temp_path.c_str(), path.c_str());
+        throw std::runtime_error(msg);
+    }
+}
+
+Checkpoint Checkpoint::load(const std::string& path)
+{
+    // a crash between removing the old file and renaming the new one leaves only the new one
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "rb") != 0 || !file) {
+        file = nullptr;
+        fopen_s(&file, (path + ".tmp").c_str(), "rb");
+    }
+    if (!file) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not open checkpoint file: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    std::vector<uint8_t> data;
+    uint8_t buffer[64 * 1024];
+    size_t size = 0;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + size);
+    }
+    fclose(file);
+
+    Reader reader(data, 0);
+    char magic[sizeof(MAGIC)];
+    for (auto& c : magic) {
+        c = reader.get<char>();
+    }
+    if (memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) {
+        static char msg[1024];
+        sprintf_s(msg, "Not a checkpoint file: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    uint32_t version = reader.get<uint32_t>();
+    if (version != VERSION) {
+        static char msg[1024];
+        sprintf_s(msg, "Unsupported checkpoint version %u, expected %u", version, VERSION);
+        throw std::invalid_argument(msg);
+    }
+
+    uint64_t checksum = reader.get<uint64_t>();
+    if (checksum != calcChecksum(data, reader.offset())) {
+        static char msg[1024];
+        sprintf_s(msg, "Checkpoint file is damaged: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    Checkpoint checkpoint;
+    checkpoint.num_players = reader.get<uint32_t>();
+    checkpoint.num_rounds = reader.get<uint32_t>();
+    checkpoint.num_tables = reader.get<uint32_t>();
+    checkpoint.num_games = reader.get<uint32_t>();
+    checkpoint.num_attempts = reader.get<uint32_t>();
+    checkpoint.num_seats = reader.get<uint32_t>();
+    checkpoint.seed = reader.get<uint64_t>();
+    checkpoint.method = reader.get<Method>();
+    checkpoint.moves = reader.get<MoveWeights>();
+    checkpoint.seat_weight = reader.get<double>();
+    checkpoint.start_seats = reader.getVector<player_t>();
+    checkpoint.phase = reader.get<Phase>();
+    checkpoint.players_seats = reader.getVector<player_t>();
+    checkpoint.first_stage = reader.get<uint64_t>();
+    checkpoint.best_seats = reader.getVector<player_t>();
+    checkpoint.best_score = reader.get<double>();
+    checkpoint.worst_score = reader.get<double>();
+    checkpoint.best_order = reader.get<uint64_t>();
+
+    uint64_t num_stages = reader.get<uint64_t>();
+    for (uint64_t stage = 0; stage < num_stages; stage++) {
+        checkpoint.stages.push_back(readStage(reader));
+    }
+
+    return checkpoint;
+}
@@ -0,0 +1,93 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "random.h"
+#include "solve.h"
+#include "types.h"
+
+//
+// struct StageCheckpoint - state of an optimization stage.
+// A finished stage keeps its result. A running stage keeps everything its optimizer
+// needs to continue: the current and the best schedule, counters, the next iteration,
+// the state of the random generator and the state specific to the optimizer.
+// A stage without a state starts again from its seed, which gives the same result.
+//
+struct StageCheckpoint
+{
+    enum class Status : uint32_t
+    {
+        NotStarted,     // the stage starts from its seed
+        Running,        // the optimizer continues from the state
+        Finished,       // seats and score are the result of the stage
+    };
+
+    Status status;
+
+    // flat seats of the current schedule, see Schedule::seats()
+    std::vector<player_t> seats;
+
+    // seats of the best schedule, empty if the current schedule is the best one
+    std::vector<player_t> best_seats;
+    double best_score;
+
+    uint64_t iteration;
+    uint64_t best_iteration;
+    uint64_t total_iterations;
+    uint64_t good_iterations;
+    uint64_t random_state[Random::StateSize];
+
+    // raw state of the optimizer, e.g. CoolingSchedule of annealing
+    std::vector<uint8_t> optimizer_state;
+};
+
+//
+// struct Checkpoint - state of a run which continues after a restart (see CheckpointWriter).
+// The file is binary: a header with the version, the state and a checksum of the state.
+// The state is read by the same build, so raw states of optimizers are not portable.
+//
+struct Checkpoint
+{
+    // optimization in progress
+    enum class Phase : uint32_t
+    {
+        Players,
+        Seats,
+    };
+
+    // the run: configuration and parameters which define the result
+    uint32_t num_players;
+    uint32_t num_rounds;
+    uint32_t num_tables;
+    uint32_t num_games;
+    uint32_t num_attempts;
+    uint32_t num_seats;
+    uint64_t seed;
+    Method method;
+    MoveWeights moves;
+    double seat_weight;
+
+    // the start of player stages, empty if stages construct their schedules
+    std::vector<player_t> start_seats;
+
+    Phase phase;
+
+    // result of player optimization, the input of seat optimization
+    std::vector<player_t> players_seats;
+
+    // stages of the previous batches: their number and the best one
+    uint64_t first_stage;
+    std::vector<player_t> best_seats;
+    double best_score;
+    double worst_score;
+    uint64_t best_order;
+
+    // stages of the current batch
+    std::vector<StageCheckpoint> stages;
+
+    // writes to a temporary file first, so a crash never leaves a broken checkpoint
+    void save(const std::string& path) const;
+
+    static Checkpoint load(const std::string& path);
+};
@@ -0,0 +1,179 @@
+#include "checkpoint_writer.h"
+
+#include <chrono>
+#include <cstdio>
+#include <stdexcept>
+
+#include "platform.h"
+#include "stop_condition.h"
+
+void CheckpointSlot::finish(const Schedule& schedule, const StageRunner::Result& result)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _state.status = StageCheckpoint::Status::Finished;
+    _state.seats = schedule.seats();
+    _state.best_seats.clear();
+    _state.best_score = result.score;
+    _state.total_iterations = result.total_iterations;
+    _state.good_iterations = result.good_iterations;
+    _state.optimizer_state.clear();
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& path, double interval,
+    const Checkpoint& run, const Checkpoint* resume)
+    : _path(path)
+    , _interval(interval)
+    , _checkpoint(run)
+    , _resume_batch(false)
+    , _frozen(false)
+    , _stop(false)
+{
+    if (resume) {
+        if (resume->num_players != run.num_players || resume->num_rounds != run.num_rounds ||
+            resume->num_tables != run.num_tables || resume->num_games != run.num_games ||
+            resume->num_seats != run.num_seats || resume->seed != run.seed || resume->method != run.method) {
+            throw std::invalid_argument("Checkpoint belongs to another run.");
+        }
+        _resume = std::make_unique<Checkpoint>(*resume);
+    }
+
+    _thread = std::thread(&CheckpointWriter::writerLoop, this);
+}
+
+CheckpointWriter::~CheckpointWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _wake.notify_all();
+    _thread.join();
+}
+
+size_t CheckpointWriter::beginPhase(Checkpoint::Phase phase, const Configuration& conf,
+    const Schedule* players_schedule, StageRunner* runner)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+
+    // the interrupted phase stays in the checkpoint
+    if (_frozen || StopCondition::isInterrupted()) {
+        _frozen = true;
+        _slots.clear();
+        return 0;
+    }
+
+    _checkpoint.phase = phase;
+    _checkpoint.players_seats.clear();
+    if (players_schedule) {
+        _checkpoint.players_seats = players_schedule->seats();
+    }
+    _checkpoint.first_stage = 0;
+    _checkpoint.best_seats.clear();
+    _checkpoint.stages.clear();
+    _slots.clear();
+    _resume_batch = false;
+
+    if (!_resume || _resume->phase != phase) {
+        return 0;
+    }
+
+    // results of the previous batches
+    if (!_resume->best_seats.empty()) {
+        runner->restore(static_cast<size_t>(_resume->first_stage),
+            std::make_unique<Schedule>(conf, _resume->best_seats),
+            _resume->best_score, _resume->worst_score, static_cast<size_t>(_resume->best_order));
+    }
+    else {
+        runner->restore(static_cast<size_t>(_resume->first_stage), nullptr, 0.0, 0.0, 0);
+    }
+
+    // stages of the current batch are taken by beginBatch
+    for (auto& stage : _resume->stages) {
+        _slots.push_back(std::make_unique<CheckpointSlot>());
+        _slots.back()->_state = std::move(stage);
+    }
+    _resume_batch = true;
+    _resume.reset();
+    return runner->stageOffset();
+}
+
+void CheckpointWriter::beginBatch(size_t num_stages, const StageRunner& runner)
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_frozen) {
+            return;
+        }
+
+        size_t best_order = 0;
+        const Schedule* best_schedule = runner.bestSchedule(&best_order);
+        _checkpoint.first_stage = runner.stageOffset();
+        _checkpoint.best_seats.clear();
+        if (best_schedule) {
+            _checkpoint.best_seats = best_schedule->seats();
+        }
+        _checkpoint.best_score = runner.bestScore();
+        _checkpoint.worst_score = runner.worstScore();
+        _checkpoint.best_order = best_order;
+
+        // a resumed batch continues with the loaded stages
+        if (_resume_batch && _slots.size() != num_stages) {
+            static char msg[1024];
+            sprintf_s(msg, "Checkpoint has %zu stages in a batch, expected %zu", _slots.size(), num_stages);
+            throw std::invalid_argument(msg);
+        }
+
+        if (!_resume_batch) {
+            _slots.clear();
+            for (size_t stage = 0; stage < num_stages; stage++) {
+                _slots.push_back(std::make_unique<CheckpointSlot>());
+            }
+        }
+        _resume_batch = false;
+    }
+
+    write();
+}
+
+void CheckpointWriter::write()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_frozen || _slots.empty()) {
+        return;
+    }
+
+    // copy the latest states, every slot is held for a moment
+    _checkpoint.stages.resize(_slots.size());
+    for (size_t stage = 0; stage < _slots.size(); stage++) {
+        std::lock_guard<std::mutex> slot_lock(_slots[stage]->_mutex);
+        _checkpoint.stages[stage] = _slots[stage]->_state;
+    }
+
+    try {
+        _checkpoint.save(_path);
+    }
+    catch (std::exception& ex) {
+        // a failed checkpoint does not stop the run, the next one may succeed
+        printf("Failed to write checkpoint: %s\n", ex.what());
+    }
+
+    // optimizers publish fresh states for the next write
+    for (auto& slot : _slots) {
+        slot->_requested.store(true, std::memory_order_relaxed);
+    }
+}
+
+void CheckpointWriter::writerLoop()
+{
+    auto interval = std::chrono::duration<double>(_interval);
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (!_stop) {
+        if (_wake.wait_for(lock, interval, [this] { return _stop; })) {
+            break;
+        }
+
+        lock.unlock();
+        write();
+        lock.lock();
+    }
+}
@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "checkpoint.h"
+#include "schedule.h"
+#include "stage_runner.h"
+
+//
+// class CheckpointSlot - exchange of the state of one stage between its optimizer
+// and CheckpointWriter. The writer requests the state, the optimizer sees the request
+// between its iterations and copies the state into buffers of the slot, which are
+// allocated only once. The optimizer never waits for the writer: if the writer
+// is reading the slot, the state is published on the next request.
+//
+class CheckpointSlot
+{
+public:
+    CheckpointSlot()
+        : _requested(false)
+    {
+        _state.status = StageCheckpoint::Status::NotStarted;
+    }
+
+    ~CheckpointSlot() = default;
+
+public:
+    // the state to continue from, nullptr if the stage starts from its seed.
+    // Valid until the optimizer publishes its own state
+    const StageCheckpoint* resumeState() const
+    {
+        return (_state.status == StageCheckpoint::Status::Running) ? &_state : nullptr;
+    }
+
+    bool isFinished() const
+    {
+        return _state.status == StageCheckpoint::Status::Finished;
+    }
+
+    // result of a finished stage
+    const StageCheckpoint& state() const
+    {
+        return _state;
+    }
+
+    bool isRequested() const
+    {
+        return _requested.load(std::memory_order_relaxed);
+    }
+
+    // fill(StageCheckpoint*) copies the state of the optimizer.
+    // Skipped if the writer holds the slot, unless wait is set (the stage is stopping)
+    template <typename Fill>
+    void publish(Fill fill, bool wait)
+    {
+        std::unique_lock<std::mutex> lock(_mutex, std::defer_lock);
+        if (wait) {
+            lock.lock();
+        }
+        else if (!lock.try_lock()) {
+            return;
+        }
+
+        fill(&_state);
+        _state.status = StageCheckpoint::Status::Running;
+        _requested.store(false, std::memory_order_relaxed);
+    }
+
+    // keeps the result of the stage, it is not run again after a restart
+    void finish(const Schedule& schedule, const StageRunner::Result& result);
+
+private:
+    friend class CheckpointWriter;
+
+    std::mutex _mutex;
+    std::atomic<bool> _requested;
+    StageCheckpoint _state;
+};
+
+//
+// class CheckpointWriter - writes the state of the run (see Checkpoint) to a file
+// on a background thread every interval and at the end of every batch of stages.
+// A run started with a loaded checkpoint continues its phase, batch and stages.
+// After an interrupt the checkpoint keeps the interrupted phase: later phases
+// only finish the output of the run and are not recorded.
+//
+class CheckpointWriter
+{
+public:
+    // run: configuration and parameters of the run, resume: loaded checkpoint or nullptr
+    CheckpointWriter(const std::string& path, double interval, const Checkpoint& run, const Checkpoint* resume);
+    ~CheckpointWriter();
+
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+public:
+    // starts player or seat optimization, players_schedule is the input of seat optimization.
+    // If the loaded checkpoint is at this phase, restores results of its previous batches
+    // and returns the index of the first stage of the batch to continue
+    size_t beginPhase(Checkpoint::Phase phase, const Configuration& conf,
+        const Schedule* players_schedule, StageRunner* runner);
+
+    // starts a batch of stages, the runner keeps the best schedule of the previous batches
+    void beginBatch(size_t num_stages, const StageRunner& runner);
+
+    // slot of a stage of the current batch, nullptr if the batch is not recorded
+    CheckpointSlot* slot(size_t stage)
+    {
+        return (stage < _slots.size()) ? _slots[stage].get() : nullptr;
+    }
+
+    // writes the checkpoint with the latest states of stages
+    void write();
+
+private:
+    void writerLoop();
+
+private:
+    std::string _path;
+    double _interval;
+
+    // header of the checkpoint and slots of the current batch
+    Checkpoint _checkpoint;
+    std::vector<std::unique_ptr<CheckpointSlot>> _slots;
+
+    // loaded checkpoint which is not continued yet
+    std::unique_ptr<Checkpoint> _resume;
+
+    // slots hold loaded stages of the batch to continue
+    bool _resume_batch;
+
+    // the phase after an interrupt is not recorded
+    bool _frozen;
+
+    std::mutex _mutex;
+    std::condition_variable _wake;
+    bool _stop;
+    std::thread _thread;
+};
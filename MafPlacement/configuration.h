@@ -1,4 +1,7 @@
 #pragma once
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
 
 //
 // class Configuration - set of common parameters
@@ -6,18 +9,25 @@
 class Configuration
 {
 public:
-    // number of players in every game
-    static const size_t NumSeats = 10;
+    // supported numbers of players in a game: 8, 10 and 12 (see dispatchSeats)
+    static const size_t DefaultSeats = 10;
+    static const size_t MaxSeats = 12;
+
+    static bool isSupportedSeats(size_t seats)
+    {
+        return seats == 8 || seats == 10 || seats == 12;
+    }
 
 public:
-    Configuration(size_t players, size_t rounds, size_t tables, size_t games, size_t attempts)
+    Configuration(size_t players, size_t rounds, size_t tables, size_t games, size_t attempts, size_t seats)
         : _numPlayers(players)
         , _numRounds(rounds)
         , _numTables(tables)
         , _numGames(games)
         , _numAttempts(attempts)
+        , _numSeats(seats)
     {
-        // empty
+        assert(isSupportedSeats(seats));
     }
 
     ~Configuration() = default;
@@ -53,10 +63,33 @@ public:
         return _numAttempts; 
     }
 
+    // number of players in every game
+    size_t numSeats() const
+    {
+        return _numSeats;
+    }
+
 private:
     size_t _numPlayers;
     size_t _numTables;
     size_t _numRounds;
     size_t _numGames;
     size_t _numAttempts;
+    size_t _numSeats;
 };
+
+// calls fn(std::integral_constant<size_t, N>()) with the number of seats N known at compile time,
+// so hot loops over seats of a game get fixed bounds for every supported number of seats
+template <typename Fn>
+auto dispatchSeats(size_t num_seats, Fn&& fn) -> decltype(fn(std::integral_constant<size_t, 10>()))
+{
+    switch (num_seats) {
+    case 8:
+        return fn(std::integral_constant<size_t, 8>());
+    case 12:
+        return fn(std::integral_constant<size_t, 12>());
+    default:
+        assert(num_seats == 10);
+        return fn(std::integral_constant<size_t, 10>());
+    }
+}
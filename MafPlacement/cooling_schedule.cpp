@@ -0,0 +1,61 @@
+#include "cooling_schedule.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+CoolingSchedule::CoolingSchedule(const CoolingParams& params, double uphill, size_t num_iterations)
+    : _params(params)
+    , _window_uphill(0)
+    , _window_accepted(0)
+    , _since_best(0)
+{
+    assert(params.initial_acceptance > 0.0 && params.initial_acceptance < 1.0);
+    assert(params.final_acceptance > 0.0 && params.final_acceptance < params.initial_acceptance);
+
+    // exp(-uphill / T) = acceptance
+    uphill = std::max(uphill, 1e-9);
+    _initial_temperature = -uphill / std::log(params.initial_acceptance);
+    _final_temperature = -uphill / std::log(params.final_acceptance);
+    _temperature = _initial_temperature;
+
+    double steps = static_cast<double>(std::max<size_t>(num_iterations, 1));
+    _alpha = std::pow(_final_temperature / _initial_temperature, 1.0 / steps);
+
+    _target_acceptance = params.initial_acceptance;
+    _acceptance_alpha = std::pow(params.final_acceptance / params.initial_acceptance, 1.0 / steps);
+}
+
+void CoolingSchedule::update(bool uphill, bool accepted, bool new_best)
+{
+    switch (_params.type) {
+    case CoolingParams::Type::Geometric:
+        _temperature *= _alpha;
+        break;
+
+    case CoolingParams::Type::Adaptive:
+        _target_acceptance *= _acceptance_alpha;
+        if (!uphill)
+            break;
+
+        _window_uphill++;
+        _window_accepted += accepted;
+        if (_window_uphill >= _params.window) {
+            double acceptance = static_cast<double>(_window_accepted) / _window_uphill;
+            _temperature *= (acceptance > _target_acceptance) ? 0.95 : 1.0 / 0.95;
+            _temperature = std::min(_temperature, _initial_temperature);
+            _window_uphill = 0;
+            _window_accepted = 0;
+        }
+        break;
+
+    case CoolingParams::Type::Reheating:
+        _temperature *= _alpha;
+        _since_best = new_best ? 0 : _since_best + 1;
+        if (_since_best >= _params.reheat_after) {
+            _temperature = std::max(_temperature, _initial_temperature * _params.reheat_ratio);
+            _since_best = 0;
+        }
+        break;
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+
+//
+// struct CoolingParams - parameters of simulated annealing cooling schedule.
+// Temperatures are set through the probability to accept a sampled uphill move,
+// so the same parameters work for player and seat scores of any scale.
+//
+struct CoolingParams
+{
+    enum class Type
+    {
+        Geometric,  // temperature decays geometrically from initial to final
+        Adaptive,   // temperature follows the target acceptance rate of uphill moves
+        Reheating,  // geometric, but temperature is raised when no new best is found for long
+    };
+
+    Type type;
+
+    // probability to accept a sampled uphill move at the beginning and at the end
+    double initial_acceptance;
+    double final_acceptance;
+
+    // adaptive: number of uphill probes between temperature corrections
+    size_t window;
+
+    // reheating: number of probes without a new best score before reheating
+    size_t reheat_after;
+
+    // reheating: temperature after reheating relative to the initial one
+    double reheat_ratio;
+
+    static CoolingParams geometric()
+    {
+        return{ Type::Geometric, 0.5, 0.0001, 0, 0, 0.0 };
+    }
+
+    static CoolingParams adaptive()
+    {
+        return{ Type::Adaptive, 0.5, 0.0001, 1000, 0, 0.0 };
+    }
+
+    static CoolingParams reheating()
+    {
+        return{ Type::Reheating, 0.5, 0.0001, 0, 100 * 1000, 0.3 };
+    }
+};
+
+//
+// class CoolingSchedule - temperature of simulated annealing during the run
+//
+class CoolingSchedule
+{
+public:
+    CoolingSchedule(const CoolingParams& params, double uphill, size_t num_iterations);
+    ~CoolingSchedule() = default;
+
+public:
+    double temperature() const
+    {
+        return _temperature;
+    }
+
+    // updates temperature after every probe
+    void update(bool uphill, bool accepted, bool new_best);
+
+private:
+    CoolingParams _params;
+
+    double _initial_temperature;
+    double _final_temperature;
+    double _temperature;
+
+    // geometric decay per probe
+    double _alpha;
+
+    // adaptive: target acceptance decay per probe and current target
+    double _acceptance_alpha;
+    double _target_acceptance;
+    size_t _window_uphill;
+    size_t _window_accepted;
+
+    // reheating: probes since the last best score
+    size_t _since_best;
+};
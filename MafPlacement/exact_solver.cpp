@@ -0,0 +1,595 @@
+#include "exact_solver.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "score.h"
+#include "thread_pool.h"
+
+// bound of a subtree which has no schedules
+static const int64_t INFEASIBLE = INT64_C(1) << 50;
+
+// number of tasks per thread, more tasks balance threads better
+static const size_t TASKS_PER_THREAD = 64;
+
+// --------------------------------------------------------------------------
+// class ExactSolver::Search - depth-first search of one thread.
+// Keeps the partial schedule, its meetings and the bound of every depth,
+// players are placed to the next free seat and removed in reverse order.
+// --------------------------------------------------------------------------
+
+class ExactSolver::Search
+{
+public:
+    Search(ExactSolver& solver);
+    ~Search() = default;
+
+public:
+    // leaves only the fixed first round
+    void reset();
+
+    // places the player to the next seat / removes the last placed player
+    void place(player_t player_id);
+    void unplace();
+
+    size_t depth() const
+    {
+        return _depth;
+    }
+
+    size_t fixedSlots() const
+    {
+        return _fixed_slots;
+    }
+
+    const std::vector<player_t>& seats() const
+    {
+        return _seats;
+    }
+
+    // twice the lower bound of pair costs of all schedules below the node
+    int64_t bound() const
+    {
+        int64_t rest = _bound_sums[_depth];
+        return (rest >= INFEASIBLE) ? INFEASIBLE : 2 * _cost + rest;
+    }
+
+    // searches the subtree, returns false if the search was stopped
+    bool run(int64_t node_bound);
+
+    // collects subtrees at the split depth as tasks instead of searching them
+    bool collect(size_t split, std::vector<Task>* tasks);
+
+    size_t numNodes() const
+    {
+        return _num_nodes;
+    }
+
+private:
+    bool search(int64_t node_bound);
+
+    size_t gameRound(size_t game_idx) const
+    {
+        return game_idx / _conf.numTables();
+    }
+
+    // first seat of the next round
+    size_t roundEnd(size_t round_idx) const
+    {
+        return std::min((round_idx + 1) * _conf.numTables(), _conf.numGames()) * _conf.numSeats();
+    }
+
+    // number of players who must play the rest of the round but are not placed yet
+    size_t countForced(size_t round_idx) const;
+
+    // marks players who played the same games as the previous player before the round
+    void updateHistory(size_t round_idx);
+
+    // updates bounds of the players after a placement
+    void updateBounds(bool game_completed, size_t first_slot);
+
+    // the cheapest increments of pair costs the player still takes
+    int64_t calcPlayerBound(player_t player_id) const;
+
+private:
+    ExactSolver& _solver;
+    const Configuration& _conf;
+    size_t _num_players;
+    size_t _num_slots;
+    size_t _fixed_slots;
+
+    // partial schedule
+    std::vector<player_t> _seats;
+    size_t _depth;
+
+    // meetings: num_players * num_players and sum of pair costs
+    std::vector<int> _meetings;
+    int64_t _cost;
+
+    // games to play which are not started, the round the player plays last
+    std::vector<int> _games_left;
+    std::vector<int> _player_round;
+    std::vector<int> _prev_rounds;
+
+    // players of the game being filled
+    std::vector<char> _in_open_game;
+
+    // games of players in every round or -1: num_players * num_rounds
+    std::vector<int> _player_games;
+
+    // if the player played the same games as the previous player before the round: num_rounds * num_players
+    std::vector<char> _same_history;
+
+    // bounds of players at every depth: (num_slots + 1) * num_players and their sums
+    std::vector<int64_t> _bounds;
+    std::vector<int64_t> _bound_sums;
+    mutable std::vector<int> _counts;
+
+    // collection of tasks
+    size_t _split;
+    std::vector<Task>* _tasks;
+
+    size_t _num_nodes;
+};
+
+ExactSolver::Search::Search(ExactSolver& solver)
+    : _solver(solver)
+    , _conf(solver._conf)
+    , _num_players(solver._conf.numPlayers())
+    , _num_slots(solver._conf.numGames() * solver._conf.numSeats())
+    , _fixed_slots(std::min(solver._conf.numTables(), solver._conf.numGames()) * solver._conf.numSeats())
+    , _seats(_num_slots, InvalidPlayerId)
+    , _depth(0)
+    , _cost(0)
+    , _same_history(solver._conf.numRounds() * _num_players, 0)
+    , _bounds((_num_slots + 1) * _num_players, 0)
+    , _bound_sums(_num_slots + 1, 0)
+    , _counts(_conf.numAttempts(), 0)
+    , _split(0)
+    , _tasks(nullptr)
+    , _num_nodes(0)
+{
+    reset();
+}
+
+void ExactSolver::Search::reset()
+{
+    // every pair starts with no meetings
+    _depth = 0;
+    _cost = static_cast<int64_t>(_num_players * (_num_players - 1) / 2) * _solver._pair_costs[0];
+    _meetings.assign(_num_players * _num_players, 0);
+    _games_left.assign(_num_players, static_cast<int>(_conf.numAttempts()));
+    _player_round.assign(_num_players, -1);
+    _player_games.assign(_num_players * _conf.numRounds(), -1);
+    _prev_rounds.assign(_num_slots, -1);
+    _in_open_game.assign(_num_players, 0);
+
+    int64_t sum = 0;
+    for (player_t id = 0; id < _num_players; id++) {
+        _bounds[id] = calcPlayerBound(id);
+        sum += _bounds[id];
+    }
+    _bound_sums[0] = std::min(sum, INFEASIBLE);
+
+    // players 0, 1, 2... play the first round
+    for (size_t slot = 0; slot < _fixed_slots; slot++) {
+        place(static_cast<player_t>(slot));
+    }
+}
+
+void ExactSolver::Search::place(player_t player_id)
+{
+    size_t slot = _depth;
+    size_t game_idx = slot / _conf.numSeats();
+    size_t seat = slot % _conf.numSeats();
+    size_t first_slot = game_idx * _conf.numSeats();
+    size_t round_idx = gameRound(game_idx);
+
+    for (size_t idx = first_slot; idx < slot; idx++) {
+        player_t other = _seats[idx];
+        int& value = _meetings[player_id * _num_players + other];
+        _cost += _solver._marginals[value];
+        value++;
+        _meetings[other * _num_players + player_id] = value;
+    }
+
+    _seats[slot] = player_id;
+    _games_left[player_id]--;
+    _prev_rounds[slot] = _player_round[player_id];
+    _player_round[player_id] = static_cast<int>(round_idx);
+
+    _player_games[player_id * _conf.numRounds() + round_idx] = static_cast<int>(game_idx);
+
+    bool completed = seat + 1 == _conf.numSeats();
+    if (completed) {
+        for (size_t idx = first_slot; idx < slot; idx++) {
+            _in_open_game[_seats[idx]] = 0;
+        }
+    }
+    else {
+        _in_open_game[player_id] = 1;
+    }
+
+    _depth++;
+    updateBounds(completed, first_slot);
+
+    if (_depth == roundEnd(round_idx) && round_idx + 1 < _conf.numRounds()) {
+        updateHistory(round_idx + 1);
+    }
+}
+
+void ExactSolver::Search::unplace()
+{
+    assert(_depth > _fixed_slots);
+    _depth--;
+
+    size_t slot = _depth;
+    size_t first_slot = slot - slot % _conf.numSeats();
+    player_t player_id = _seats[slot];
+
+    if (slot % _conf.numSeats() + 1 == _conf.numSeats()) {
+        for (size_t idx = first_slot; idx < slot; idx++) {
+            _in_open_game[_seats[idx]] = 1;
+        }
+    }
+    else {
+        _in_open_game[player_id] = 0;
+    }
+
+    _player_round[player_id] = _prev_rounds[slot];
+    _player_games[player_id * _conf.numRounds() + gameRound(slot / _conf.numSeats())] = -1;
+    _games_left[player_id]++;
+    _seats[slot] = InvalidPlayerId;
+
+    for (size_t idx = first_slot; idx < slot; idx++) {
+        player_t other = _seats[idx];
+        int& value = _meetings[player_id * _num_players + other];
+        value--;
+        _meetings[other * _num_players + player_id] = value;
+        _cost -= _solver._marginals[value];
+    }
+}
+
+size_t ExactSolver::Search::countForced(size_t round_idx) const
+{
+    int rounds_after = static_cast<int>(_conf.numRounds() - 1 - round_idx);
+    size_t count = 0;
+    for (player_t id = 0; id < _num_players; id++) {
+        if (_player_round[id] != static_cast<int>(round_idx) && _games_left[id] > rounds_after)
+            count++;
+    }
+    return count;
+}
+
+void ExactSolver::Search::updateHistory(size_t round_idx)
+{
+    size_t num_rounds = _conf.numRounds();
+    char* same = &_same_history[round_idx * _num_players];
+    same[0] = 0;
+    for (player_t id = 1; id < _num_players; id++) {
+        const int* games = &_player_games[id * num_rounds];
+        same[id] = std::equal(games, games + round_idx, games - num_rounds);
+    }
+}
+
+void ExactSolver::Search::updateBounds(bool game_completed, size_t first_slot)
+{
+    int64_t* bounds = &_bounds[_depth * _num_players];
+    const int64_t* prev = &_bounds[(_depth - 1) * _num_players];
+
+    // a completed game changes caps of meetings of its players with everybody,
+    // otherwise only the players of the open game change
+    if (game_completed) {
+        for (player_t id = 0; id < _num_players; id++) {
+            bounds[id] = calcPlayerBound(id);
+        }
+    }
+    else {
+        std::copy(prev, prev + _num_players, bounds);
+        for (size_t idx = first_slot; idx < _depth; idx++) {
+            player_t id = _seats[idx];
+            bounds[id] = calcPlayerBound(id);
+        }
+    }
+
+    int64_t sum = 0;
+    for (player_t id = 0; id < _num_players; id++) {
+        sum += bounds[id];
+    }
+    _bound_sums[_depth] = std::min(sum, INFEASIBLE);
+}
+
+int64_t ExactSolver::Search::calcPlayerBound(player_t player_id) const
+{
+    // the player meets seats - 1 players in every game to play and the rest of the open game
+    size_t filled = _depth % _conf.numSeats();
+    int open_seats = filled ? static_cast<int>(_conf.numSeats() - filled) : 0;
+    bool in_open = _in_open_game[player_id] != 0;
+    int games_left = _games_left[player_id];
+    int required = static_cast<int>(_conf.numSeats() - 1) * games_left + (in_open ? open_seats : 0);
+    if (required == 0) {
+        return 0;
+    }
+
+    // a pair meets at most once in every game both players may still play
+    std::fill(_counts.begin(), _counts.end(), 0);
+    const int* row = &_meetings[player_id * _num_players];
+    int capacity = 0;
+    for (player_t other = 0; other < _num_players; other++) {
+        if (other == player_id)
+            continue;
+
+        int cap = (in_open && _in_open_game[other])
+            ? std::min(games_left, _games_left[other])
+            : std::min(games_left + in_open, _games_left[other] + _in_open_game[other]);
+        for (int k = 0; k < cap; k++) {
+            _counts[row[other] + k]++;
+        }
+        capacity += cap;
+    }
+
+    if (capacity < required) {
+        return INFEASIBLE;
+    }
+
+    // the cheapest increments of all pairs, the cost is convex or not
+    int64_t cost = 0;
+    for (int level : _solver._levels) {
+        int take = std::min(_counts[level], required);
+        cost += take * _solver._marginals[level];
+        required -= take;
+        if (required == 0)
+            break;
+    }
+    return cost;
+}
+
+bool ExactSolver::Search::run(int64_t node_bound)
+{
+    _split = 0;
+    _tasks = nullptr;
+    return search(node_bound);
+}
+
+bool ExactSolver::Search::collect(size_t split, std::vector<Task>* tasks)
+{
+    _split = split;
+    _tasks = tasks;
+    bool completed = search(bound());
+    _split = 0;
+    _tasks = nullptr;
+    return completed;
+}
+
+bool ExactSolver::Search::search(int64_t node_bound)
+{
+    if (++_num_nodes % 4096 == 0) {
+        _solver.checkStop();
+    }
+
+    if (_solver._stop) {
+        _solver.updateAbortedBound(node_bound);
+        return false;
+    }
+
+    if (_depth == _num_slots) {
+        _solver.updateBest(2 * _cost, _seats);
+        return true;
+    }
+
+    if (_depth == _split) {
+        Task task = { std::vector<player_t>(_seats.begin() + _fixed_slots, _seats.begin() + _depth), node_bound };
+        _tasks->push_back(std::move(task));
+        return true;
+    }
+
+    size_t slot = _depth;
+    size_t game_idx = slot / _conf.numSeats();
+    size_t seat = slot % _conf.numSeats();
+    size_t round_idx = gameRound(game_idx);
+    int round = static_cast<int>(round_idx);
+    int rounds_after = static_cast<int>(_conf.numRounds() - 1 - round_idx);
+    size_t seats_after = roundEnd(round_idx) - slot - 1;
+
+    // players of a game increase, games of a round are ordered by their first players
+    player_t low = 0;
+    if (seat > 0) {
+        low = _seats[slot - 1] + 1;
+    }
+    else if (game_idx > round_idx * _conf.numTables()) {
+        low = _seats[slot - _conf.numSeats()] + 1;
+    }
+
+    // players who played the same games so far are interchangeable,
+    // the one with the lower id takes the earlier game of the round
+    const char* same_history = &_same_history[round_idx * _num_players];
+
+    for (player_t id = low; id < _num_players; id++) {
+        bool free = _player_round[id] != round && _games_left[id] > 0;
+        if (free && !(same_history[id] && _player_round[id - 1] != round)) {
+            place(id);
+            if (countForced(round_idx) <= seats_after) {
+                int64_t bound = this->bound();
+                if (bound < _solver._best_cost.load() && !search(bound)) {
+                    unplace();
+                    _solver.updateAbortedBound(node_bound);
+                    return false;
+                }
+            }
+            unplace();
+        }
+
+        // a player skipped by the first seat of a game can only rest this round
+        if (seat == 0 && _player_round[id] != round && _games_left[id] > rounds_after)
+            break;
+    }
+
+    return true;
+}
+
+// --------------------------------------------------------------------------
+// class ExactSolver
+// --------------------------------------------------------------------------
+
+ExactSolver::ExactSolver(const Configuration& conf, size_t num_threads, double time_limit,
+    const StopCondition& stop)
+    : _conf(conf)
+    , _num_threads(num_threads)
+    , _time_limit(time_limit)
+    , _stop_condition(stop)
+    , _best_cost(INFEASIBLE)
+    , _aborted_bound(INFEASIBLE)
+    , _stop(false)
+    , _score(0.0)
+    , _lower_bound(0.0)
+    , _optimal(false)
+    , _num_nodes(0)
+    , _num_tasks(0)
+{
+    // a pair meets at most "attempts" times
+    int max_meetings = static_cast<int>(conf.numAttempts());
+    for (int value = 0; value <= max_meetings; value++) {
+        _pair_costs.push_back(calcPairCost(value));
+    }
+
+    for (int value = 0; value < max_meetings; value++) {
+        _marginals.push_back(_pair_costs[value + 1] - _pair_costs[value]);
+        _levels.push_back(value);
+    }
+
+    std::stable_sort(_levels.begin(), _levels.end(), [this](int one, int two) {
+        return _marginals[one] < _marginals[two];
+    });
+}
+
+int64_t ExactSolver::calcPairCost(int meetings) const
+{
+    // square deviation and pair penalty of calcPlayerScore multiplied by (num_players - 1) / 2,
+    // the linear part of the deviation does not depend on the schedule
+    int64_t penalty_weight = static_cast<int64_t>(_conf.numPlayers() - 1);
+    return static_cast<int64_t>(meetings) * meetings + penalty_weight * calcPairPenalty(meetings);
+}
+
+double ExactSolver::calcScore(double double_cost) const
+{
+    double num_players = static_cast<double>(_conf.numPlayers());
+    double pairs = num_players * (num_players - 1) / 2.0;
+    double sum_meetings = (_conf.numSeats() * (_conf.numSeats() - 1) / 2.0) * _conf.numGames();
+    double target = calcPlayerTarget(_conf);
+    return 2.0 * (double_cost / 2.0 - 2.0 * target * sum_meetings + pairs * target * target) / (num_players - 1);
+}
+
+void ExactSolver::updateBest(int64_t cost, const std::vector<player_t>& seats)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (cost < _best_cost.load()) {
+        _best_cost = cost;
+        _best_seats = seats;
+    }
+}
+
+void ExactSolver::updateAbortedBound(int64_t bound)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _aborted_bound = std::min(_aborted_bound, bound);
+}
+
+bool ExactSolver::checkStop()
+{
+    if (_stop_condition.isExpired()) {
+        _stop = true;
+    }
+
+    if (_time_limit > 0.0) {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - _start_time;
+        if (elapsed.count() >= _time_limit) {
+            _stop = true;
+        }
+    }
+    return _stop;
+}
+
+std::unique_ptr<Schedule> ExactSolver::solve(const Schedule& incumbent)
+{
+    _start_time = std::chrono::steady_clock::now();
+    _stop = false;
+    _aborted_bound = INFEASIBLE;
+
+    // the incumbent is the best schedule so far
+    size_t num_players = _conf.numPlayers();
+    std::vector<int> meetings(num_players * num_players, 0);
+    for (const auto& game : incumbent.games()) {
+        const auto& seats = game.seats();
+        for (size_t i = 0; i < seats.size(); i++) {
+            for (size_t j = 0; j < i; j++) {
+                meetings[seats[i] * num_players + seats[j]]++;
+            }
+        }
+    }
+
+    int64_t cost = 0;
+    for (size_t a = 0; a < num_players; a++) {
+        for (size_t b = 0; b < a; b++) {
+            cost += _pair_costs[meetings[a * num_players + b] + meetings[b * num_players + a]];
+        }
+    }
+    _best_cost = 2 * cost;
+    _best_seats = incumbent.seats();
+
+    ThreadPool pool(_num_threads);
+    std::vector<std::unique_ptr<Search>> searches;
+    for (size_t worker = 0; worker < pool.numThreads(); worker++) {
+        searches.push_back(std::make_unique<Search>(*this));
+    }
+
+    // split the tree deeper until every thread has enough subtrees,
+    // no subtrees means the whole tree is searched
+    Search& root = *searches[0];
+    size_t num_slots = _conf.numGames() * _conf.numSeats();
+    size_t target_tasks = TASKS_PER_THREAD * pool.numThreads();
+    std::vector<Task> tasks;
+    for (size_t split = root.fixedSlots() + 1; split <= num_slots; split++) {
+        tasks.clear();
+        if (root.bound() < _best_cost.load() && !root.collect(split, &tasks))
+            break;
+        if (tasks.empty() || tasks.size() >= target_tasks)
+            break;
+    }
+    _num_tasks = tasks.size();
+
+    pool.run(tasks.size(), [&](size_t task_idx, size_t worker) {
+        const auto& task = tasks[task_idx];
+        if (_stop) {
+            updateAbortedBound(task.bound);
+            return;
+        }
+
+        Search& search = *searches[worker];
+        search.reset();
+        for (auto id : task.seats) {
+            search.place(id);
+        }
+
+        if (task.bound < _best_cost.load()) {
+            search.run(task.bound);
+        }
+    });
+
+    _num_nodes = 0;
+    for (const auto& search : searches) {
+        _num_nodes += search->numNodes();
+    }
+
+    // results
+    int64_t best_cost = _best_cost.load();
+    _optimal = !_stop;
+    _score = calcScore(static_cast<double>(best_cost));
+    _lower_bound = _optimal ? _score : calcScore(std::min(best_cost, _aborted_bound));
+
+    std::vector<std::vector<player_t>> games(_conf.numGames());
+    for (size_t game_idx = 0; game_idx < games.size(); game_idx++) {
+        auto first = _best_seats.begin() + game_idx * _conf.numSeats();
+        games[game_idx].assign(first, first + _conf.numSeats());
+    }
+    return std::make_unique<Schedule>(_conf, games);
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "configuration.h"
+#include "schedule.h"
+#include "stop_condition.h"
+
+//
+// class ExactSolver - branch-and-bound search of the schedule with the lowest player score
+// (see calcPlayerScore) for small tournaments.
+// Relabeling of players is broken: players of a game go in increasing order,
+// games of a round are ordered by their first players, and of two players who played
+// the same games so far the lower one takes the earlier game (or the other one rests).
+// So the first round is fixed to players 0, 1, 2...
+// Games are filled player by player, every node is pruned by a lower bound of the score:
+// meetings so far plus the cheapest meetings every player can still take
+// (water-filling of convex pair costs, each player is bounded separately).
+// Subtrees at a split depth are tasks of a thread pool, idle threads take the next one.
+// The search stops at the time limit or on StopCondition
+// and reports the best schedule with a proven lower bound.
+//
+class ExactSolver
+{
+public:
+    // zero number of threads means all hardware threads, zero time limit means no limit
+    ExactSolver(const Configuration& conf, size_t num_threads, double time_limit, const StopCondition& stop);
+    ~ExactSolver() = default;
+
+public:
+    // looks for a schedule better than the incumbent and returns the best schedule found
+    std::unique_ptr<Schedule> solve(const Schedule& incumbent);
+
+    // player score of the best schedule
+    double score() const
+    {
+        return _score;
+    }
+
+    // no schedule has a score below the bound, it equals the score when the search is complete
+    double lowerBound() const
+    {
+        return _lower_bound;
+    }
+
+    bool isOptimal() const
+    {
+        return _optimal;
+    }
+
+    size_t numNodes() const
+    {
+        return _num_nodes;
+    }
+
+    size_t numTasks() const
+    {
+        return _num_tasks;
+    }
+
+private:
+    class Search;
+
+    // subtree of the search: seats after the fixed round and the bound of its root
+    struct Task
+    {
+        std::vector<player_t> seats;
+        int64_t bound;
+    };
+
+    // cost of a pair (scaled to integers) which meets "meetings" times
+    int64_t calcPairCost(int meetings) const;
+
+    // converts twice the sum of pair costs to the player score
+    double calcScore(double double_cost) const;
+
+    // keeps the schedule if it is better than the best one, thread safe
+    void updateBest(int64_t cost, const std::vector<player_t>& seats);
+
+    // keeps the lowest bound of an unexplored subtree, thread safe
+    void updateAbortedBound(int64_t bound);
+
+    // checks the time limit and returns true if the search must stop
+    bool checkStop();
+
+private:
+    const Configuration& _conf;
+    size_t _num_threads;
+    double _time_limit;
+    const StopCondition& _stop_condition;
+
+    // pair costs and their increments by number of meetings
+    std::vector<int64_t> _pair_costs;
+    std::vector<int64_t> _marginals;
+
+    // numbers of meetings ordered by the increment of the pair cost
+    std::vector<int> _levels;
+
+    // the best schedule, costs are twice the sum of pair costs
+    std::atomic<int64_t> _best_cost;
+    std::vector<player_t> _best_seats;
+    int64_t _aborted_bound;
+    std::mutex _mutex;
+
+    std::chrono::steady_clock::time_point _start_time;
+    std::atomic<bool> _stop;
+
+    // results
+    double _score;
+    double _lower_bound;
+    bool _optimal;
+    size_t _num_nodes;
+    size_t _num_tasks;
+};
@@ -1,91 +1,12 @@
 #include "game.h"
 
-Game::Game(const Configuration& config, const std::vector<player_t>& seats)
-    : _config(config)
-{
-    // sanity check
-    if (seats.size() != Configuration::NumSeats) {
-        char msg[4096];
-        sprintf_s(msg, "Can not create a game, expected number of seats %zu, got %zu instead.",
-            Configuration::NumSeats, seats.size());
-        throw std::invalid_argument(msg);
-    }
-
-    // populate seats
-    _seats = std::move(seats);
-
-    // populate players' seats
-    _players.resize(_config.numPlayers(), InvalidSeatId);
-    for (size_t idx = 0; idx < _seats.size(); idx++) {
-        auto player_id = seats[idx];
-
-        assert(player_id >= 0 && player_id < _config.numPlayers());
-        assert(_players[player_id] == InvalidSeatId);
-        _players[player_id] = static_cast<seat_t>(idx);
-    }
-}
-
-// returns a map seat -> player_id
-const std::vector<player_t>& Game::seats() const
-{
-    return _seats;
-}
-
-// returns a map: player_id -> their seat in this game
-// or NoSeat this player does not take part in a game
-const std::vector<seat_t>& Game::players() const
-{
-    return _players;
-}
-
-bool Game::participates(player_t player_id) const
-{
-    return _players[player_id] != InvalidSeatId;
-}
-
-// returns player id of given seat index
-player_t Game::getPlayerAtSeat(seat_t seat_idx) const
-{
-    return _seats[seat_idx];
-}
+#include "zobrist.h"
 
-// changes player id of given seat index
-void Game::putPlayerToSeat(seat_t seat_idx, player_t new_player_id)
+uint64_t Game::calcHash(const player_t* seats, size_t num_seats)
 {
-    assert(new_player_id >= 0 && new_player_id < _config.numPlayers());
-
-    auto old_player_id = _seats[seat_idx];
-    _seats[seat_idx] = new_player_id;
-
-    _players[old_player_id] = InvalidSeatId;
-    _players[new_player_id] = seat_idx;
-}
-
-bool Game::canSubstitutePlayer(player_t a, player_t b) const
-{
-    return _players[a] != InvalidSeatId && _players[b] == InvalidSeatId;
-}
-
-void Game::substitutePlayer(player_t a, player_t b)
-{
-    auto seat = _players[a];
-    assert(canSubstitutePlayer(a, b));
-
-    assert(_seats[seat] == a);
-    _seats[seat] = b;
-
-    _players[a] = InvalidSeatId;
-    _players[b] = seat;
+    uint64_t hash = 0;
+    for (size_t idx = 0; idx < num_seats; idx++) {
+        hash ^= zobristSeatKey(idx, seats[idx]);
+    }
+    return hash;
 }
-
-void Game::switchSeats(size_t seat_one, size_t seat_two)
-{
-    assert(seat_one < Configuration::NumSeats);
-    assert(seat_two < Configuration::NumSeats);
-
-    auto player_one = _seats[seat_one];
-    auto player_two = _seats[seat_two];
-
-    std::swap(_seats[seat_one], _seats[seat_two]);
-    std::swap(_players[player_one], _players[player_two]);
-}
\ No newline at end of file
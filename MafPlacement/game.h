@@ -1,54 +1,135 @@
 #pragma once
 #include <cassert>
-#include <vector>
 
 #include "configuration.h"
+#include "span.h"
 #include "types.h"
 
 //
-// class Game - represents who plays in mafia game
-// and what seats each player holds
+// class Game - a view of one game of a schedule:
+// who plays in mafia game and what seats each player holds.
+// Seats live in the flat seat array of Schedule, the view does not own them,
+// all changes go through Schedule.
 //
 class Game
 {
 public:
-    Game(const Configuration& config, const std::vector<player_t>& seats);
-    ~Game() = default;
+    typedef Span<const player_t> Seats;
 
 public:
-    bool valid() const
+    Game(const player_t* seats, size_t num_seats, uint64_t hash)
+        : _seats(seats)
+        , _num_seats(num_seats)
+        , _hash(hash)
+    {}
+
+public:
+    // returns a map seat -> player_id
+    // size of array: Configuration::numSeats()
+    Seats seats() const
+    {
+        return Seats(_seats, _num_seats);
+    }
+
+    size_t numSeats() const
+    {
+        return _num_seats;
+    }
+
+    // returns player id of given seat index
+    player_t getPlayerAtSeat(seat_t seat_idx) const
     {
-        return !_seats.empty() && !_players.empty();
+        assert(seat_idx < _num_seats);
+        return _seats[seat_idx];
     }
 
+    // Zobrist hash of players at seats
+    uint64_t hash() const
+    {
+        return _hash;
+    }
+
+    // calculates Zobrist hash of players at seats
+    static uint64_t calcHash(const player_t* seats, size_t num_seats);
+
+private:
+    const player_t* _seats;
+    size_t _num_seats;
+    uint64_t _hash;
+};
+
+//
+// class GameSpan - a view of consecutive games of a schedule,
+// iterates games without any allocation
+//
+class GameSpan
+{
 public:
-    // returns a map seat -> player_id
-    // size of array: 10 (Configuration::NumSeats)
-    const std::vector<player_t>& seats() const;
+    class Iterator
+    {
+    public:
+        Iterator(const player_t* seats, size_t num_seats, const uint64_t* hash)
+            : _seats(seats)
+            , _num_seats(num_seats)
+            , _hash(hash)
+        {}
 
-    // returns a map: player_id -> their seat in this game
-    // or NoSeat this player does not take part in a game
-    // size of array: Configuration::NumPlayers
-    const std::vector<seat_t>& players() const;
+        Game operator*() const
+        {
+            return Game(_seats, _num_seats, *_hash);
+        }
 
-    // returns if player_id participates in the game
-    bool participates(player_t player_id) const;
+        Iterator& operator++()
+        {
+            _seats += _num_seats;
+            _hash++;
+            return *this;
+        }
 
-    // returns player id of given seat index
-    player_t getPlayerAtSeat(seat_t seat_idx) const;
+        bool operator!=(const Iterator& other) const
+        {
+            return _hash != other._hash;
+        }
+
+    private:
+        const player_t* _seats;
+        size_t _num_seats;
+        const uint64_t* _hash;
+    };
+
+public:
+    GameSpan(const player_t* seats, size_t num_seats, const uint64_t* hashes, size_t size)
+        : _seats(seats)
+        , _num_seats(num_seats)
+        , _hashes(hashes)
+        , _size(size)
+    {}
+
+public:
+    size_t size() const
+    {
+        return _size;
+    }
 
-    // changes player id of given seat index
-    void putPlayerToSeat(seat_t seat_idx, player_t new_player_id);
+    Game operator[](size_t idx) const
+    {
+        assert(idx < _size);
+        return Game(_seats + idx * _num_seats, _num_seats, _hashes[idx]);
+    }
 
-    bool canSubstitutePlayer(player_t a, player_t b) const;
-    
-    void substitutePlayer(player_t a, player_t b);
+    Iterator begin() const
+    {
+        return Iterator(_seats, _num_seats, _hashes);
+    }
 
-    void switchSeats(size_t seat_one, size_t seat_two);
+    Iterator end() const
+    {
+        return Iterator(_seats + _size * _num_seats, _num_seats, _hashes + _size);
+    }
 
 private:
-    const Configuration& _config;
-    
-    std::vector<player_t> _seats;
-    std::vector<seat_t> _players;
+    const player_t* _seats;
+    size_t _num_seats;
+    const uint64_t* _hashes;
+    size_t _size;
 };
@@ -1,6 +1,9 @@
 #pragma once
+#include <cstdint>
 #include <string>
 
+#include "platform.h"
+
 class Log
 {
 public:
@@ -0,0 +1,57 @@
+#include "lower_bound.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "score.h"
+
+double calcPlayerLowerBound(const Configuration& conf)
+{
+    // the score of a player is (sum (m - t)^2) / (num_players - 1) + sum penalty(m) over opponents,
+    // so a pair costs m^2 + (num_players - 1) * penalty(m) and the linear part is fixed
+    const int64_t num_opponents = static_cast<int64_t>(conf.numPlayers() - 1);
+    const int64_t num_meetings = static_cast<int64_t>((conf.numSeats() - 1) * conf.numAttempts());
+    const int max_meetings = static_cast<int>(conf.numAttempts());
+    auto calc_pair_cost = [num_opponents](int meetings) {
+        return static_cast<int64_t>(meetings) * meetings + num_opponents * calcPairPenalty(meetings);
+    };
+
+    // every opponent starts at zero meetings, each further meeting adds a marginal cost.
+    // Taking the cheapest marginals first ignores their order in a pair,
+    // which only relaxes the bound when the pair cost is not convex
+    std::vector<int64_t> marginals;
+    for (int value = 0; value < max_meetings; value++) {
+        marginals.push_back(calc_pair_cost(value + 1) - calc_pair_cost(value));
+    }
+    std::sort(marginals.begin(), marginals.end());
+
+    int64_t cost = num_opponents * calc_pair_cost(0);
+    int64_t meetings_left = num_meetings;
+    for (int64_t marginal : marginals) {
+        int64_t count = std::min(meetings_left, num_opponents);
+        cost += count * marginal;
+        meetings_left -= count;
+        if (meetings_left == 0)
+            break;
+    }
+
+    double target = calcPlayerTarget(conf);
+    double sum_squares = static_cast<double>(cost) - 2.0 * target * num_meetings
+        + num_opponents * target * target;
+    return conf.numPlayers() * sum_squares / num_opponents;
+}
+
+double calcSeatLowerBound(const Configuration& conf)
+{
+    // the best a player can do is to take every seat either floor or ceil of the target times
+    const size_t num_seats = conf.numSeats();
+    const size_t base = conf.numAttempts() / num_seats;
+    const size_t num_extra = conf.numAttempts() % num_seats;
+
+    double target = calcSeatTarget(conf);
+    double low = base - target;
+    double high = base + 1.0 - target;
+    double sum_squares = num_extra * high * high + (num_seats - num_extra) * low * low;
+    return conf.numPlayers() * sum_squares / num_seats;
+}
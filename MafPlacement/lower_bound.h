@@ -0,0 +1,17 @@
+#pragma once
+
+#include "configuration.h"
+
+// --------------------------------------------------------------------------
+// analytic lower bounds of the scores (see score.h) for a configuration.
+// A bound follows from the integrality of counts of every player alone:
+// meetings with opponents add up to (seats - 1) * attempts and take whole values
+// around the target, seats add up to attempts. The optimum of the schedule may be
+// above the bound, a schedule with the score at the bound is optimal.
+// --------------------------------------------------------------------------
+
+// the least score of players' opponents distribution (calcPlayerScore)
+double calcPlayerLowerBound(const Configuration& conf);
+
+// the least score of players' seats distribution (calcSeatScore)
+double calcSeatLowerBound(const Configuration& conf);
@@ -1,19 +1,19 @@
 #include "metrics.h"
 #include <cassert>
+#include <climits>
 
 // histogram of player seats
 std::vector<int> 
 Metrics::calcPlayerSeatsHistogram(player_t player_id)
 {
-    std::vector<int> player_seats(Configuration::NumSeats, 0);
-    for (const auto& game : _schedule.games())
+    std::vector<int> player_seats(_schedule.config().numSeats(), 0);
+    for (size_t round = 0; round < _schedule.config().numRounds(); round++)
     {
-        if (!game.participates(player_id)) {
-            continue;
+        size_t game_idx;
+        seat_t pos;
+        if (_schedule.findPlayer(round, player_id, &game_idx, &pos)) {
+            player_seats[pos]++;
         }
-
-        seat_t pos = game.players()[player_id];
-        player_seats[pos]++;
     }
 
     return player_seats;
@@ -24,18 +24,27 @@ std::vector<int>
 Metrics::calcPlayerOpponentsHistogram(player_t player_id)
 {
     std::vector<int> player_opponents(_schedule.config().numPlayers(), 0);
-    for (const auto& game : _schedule.games())
-    {
-        if (!game.participates(player_id)) {
-            continue;
-        }
+    bitsets().calcOpponents(player_id, player_opponents.data());
+    return player_opponents;
+}
 
-        for (auto id : game.seats()) {
-            player_opponents[id]++;
-        }
+const PlayerBitsets& Metrics::bitsets()
+{
+    if (_bitsets_version != _schedule.version()) {
+        _bitsets.reset();
+        _bitsets_version = _schedule.version();
     }
+    return _bitsets;
+}
 
-    return player_opponents;
+const MetricsSnapshot& Metrics::snapshot()
+{
+    if (!_snapshot_valid || _snapshot_version != _schedule.version()) {
+        _snapshot.update(_schedule);
+        _snapshot_valid = true;
+        _snapshot_version = _schedule.version();
+    }
+    return _snapshot;
 }
 
 double Metrics::aggregate(const std::vector<int>& v, size_t exclude_idx, std::function<double(int)> fn)
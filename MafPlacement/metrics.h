@@ -1,4 +1,6 @@
 #pragma once
+#include "metrics_snapshot.h"
+#include "player_bitsets.h"
 #include "schedule.h"
 
 //
@@ -10,6 +12,10 @@ class Metrics
 public:
     Metrics(const Schedule& schedule)
         : _schedule(schedule)
+        , _bitsets(schedule)
+        , _bitsets_version(schedule.version())
+        , _snapshot_valid(false)
+        , _snapshot_version(0)
     {}
 
     ~Metrics() = default;
@@ -35,7 +41,19 @@ public:
     static double calcSquareDeviation(const std::vector<int>& v, size_t exclude_idx);
     static double calcSquareDeviation(const std::vector<int>& v, size_t exclude_idx, double target);
 
+    // games of players as bitsets, rebuilt when the schedule is changed
+    const PlayerBitsets& bitsets();
+
+    // all histograms and statistics, rebuilt when the schedule is changed
+    const MetricsSnapshot& snapshot();
+
 private:
     const Schedule& _schedule;
+    PlayerBitsets _bitsets;
+    uint64_t _bitsets_version;
+
+    MetricsSnapshot _snapshot;
+    bool _snapshot_valid;
+    uint64_t _snapshot_version;
 
 };
@@ -0,0 +1,87 @@
+#include "metrics_snapshot.h"
+
+#include <climits>
+
+#include "score.h"
+
+MetricsSnapshot::MetricsSnapshot()
+    : _num_players(0)
+    , _num_seats(0)
+    , _player_score(0.0)
+    , _seat_score(0.0)
+{
+}
+
+void MetricsSnapshot::update(const Schedule& schedule)
+{
+    const auto& conf = schedule.config();
+    _num_players = conf.numPlayers();
+    _num_seats = conf.numSeats();
+
+    // histograms: a single pass over all games
+    _opponents.assign(_num_players * _num_players, 0);
+    _seats.assign(_num_players * _num_seats, 0);
+    for (const auto& game : schedule.games()) {
+        const auto& players = game.seats();
+        for (size_t seat = 0; seat < players.size(); seat++) {
+            int* row = &_opponents[players[seat] * _num_players];
+            for (auto id : players) {
+                row[id]++;
+            }
+            _seats[players[seat] * _num_seats + seat]++;
+        }
+    }
+
+    // statistics of every player
+    _opponent_stats.resize(_num_players);
+    _seat_stats.resize(_num_players);
+
+    double player_target = calcPlayerTarget(conf);
+    double seat_target = calcSeatTarget(conf);
+    _player_score = 0.0;
+    _seat_score = 0.0;
+    for (player_t player = 0; player < _num_players; player++) {
+        auto& opponent_stats = _opponent_stats[player];
+        reduce(opponents(player), _num_players, player, player_target, true, &opponent_stats);
+        _player_score += opponent_stats.sd_target + opponent_stats.penalty;
+
+        auto& seat_stats = _seat_stats[player];
+        reduce(seats(player), _num_seats, _num_seats, seat_target, false, &seat_stats);
+        _seat_score += seat_stats.sd_target;
+    }
+}
+
+void MetricsSnapshot::reduce(const int* values, size_t size, size_t exclude_idx,
+    double target, bool with_penalty, Stats* out_stats)
+{
+    int min_value = INT_MAX;
+    int max_value = INT_MIN;
+    int zeros = 0;
+    int64_t sum = 0;
+    int64_t sum_squares = 0;
+    int64_t penalty = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (i == exclude_idx)
+            continue;
+
+        int value = values[i];
+        min_value = (value < min_value) ? value : min_value;
+        max_value = (value > max_value) ? value : max_value;
+        zeros += (value == 0);
+        sum += value;
+        sum_squares += value * value;
+        if (with_penalty)
+            penalty += calcPairPenalty(value);
+    }
+
+    // sum (v - t)^2 = sum v^2 - 2 * t * sum v + count * t^2
+    double count = static_cast<double>(exclude_idx < size ? size - 1 : size);
+    double average = sum / count;
+    out_stats->min = min_value;
+    out_stats->max = max_value;
+    out_stats->zeros = zeros;
+    out_stats->average = average;
+    out_stats->sd = (sum_squares - sum * average) / count;
+    out_stats->sd_target = (sum_squares - 2.0 * target * sum + count * target * target) / count;
+    out_stats->penalty = penalty;
+}
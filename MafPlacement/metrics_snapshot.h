@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "schedule.h"
+
+//
+// class MetricsSnapshot - opponent and seat histograms of all players
+// built in a single pass over the games, and statistics of every histogram
+// computed by one fused reduction.
+// Buffers are reused, so updates of schedules with the same configuration
+// do not allocate memory after the first one.
+//
+class MetricsSnapshot
+{
+public:
+    // statistics of a histogram
+    struct Stats
+    {
+        int min;
+        int max;
+        int zeros;
+        double average;
+
+        // mean square deviation from the average and from the target
+        double sd;
+        double sd_target;
+
+        // sum of pair penalties, only for opponents
+        int64_t penalty;
+    };
+
+public:
+    MetricsSnapshot();
+    ~MetricsSnapshot() = default;
+
+public:
+    // rebuilds histograms and statistics of the schedule
+    void update(const Schedule& schedule);
+
+    size_t numPlayers() const
+    {
+        return _num_players;
+    }
+
+    size_t numSeats() const
+    {
+        return _num_seats;
+    }
+
+    // meetings of the player with every player, own entry is number of games played
+    // size of array: number of players
+    const int* opponents(player_t player_id) const
+    {
+        return &_opponents[player_id * _num_players];
+    }
+
+    // how many times the player took every seat
+    // size of array: number of seats
+    const int* seats(player_t player_id) const
+    {
+        return &_seats[player_id * _num_seats];
+    }
+
+    // statistics of opponents, own entry is excluded
+    const Stats& opponentStats(player_t player_id) const
+    {
+        return _opponent_stats[player_id];
+    }
+
+    // statistics of seats
+    const Stats& seatStats(player_t player_id) const
+    {
+        return _seat_stats[player_id];
+    }
+
+    // score of players' opponents distribution, see calcPlayerScore
+    double playerScore() const
+    {
+        return _player_score;
+    }
+
+    // score of players' seats distribution, see calcSeatScore
+    double seatScore() const
+    {
+        return _seat_score;
+    }
+
+private:
+    // fused min/max/zeros/average/deviation/penalty of values except exclude_idx
+    static void reduce(const int* values, size_t size, size_t exclude_idx,
+        double target, bool with_penalty, Stats* out_stats);
+
+private:
+    size_t _num_players;
+    size_t _num_seats;
+
+    // num_players * num_players
+    std::vector<int> _opponents;
+
+    // num_players * num_seats
+    std::vector<int> _seats;
+
+    std::vector<Stats> _opponent_stats;
+    std::vector<Stats> _seat_stats;
+
+    double _player_score;
+    double _seat_score;
+};
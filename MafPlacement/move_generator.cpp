@@ -0,0 +1,190 @@
+#include "move_generator.h"
+
+#include <cassert>
+
+void MoveGenerator::getRoundGames(size_t round, size_t* out_first, size_t* out_count) const
+{
+    auto games = _schedule.round(round);
+    *out_first = games.firstGame();
+    *out_count = games.games().size();
+}
+
+SwapMoveGenerator::SwapMoveGenerator(const Schedule& schedule)
+    : MoveGenerator(schedule)
+{
+    for (size_t round = 0; round < schedule.config().numRounds(); round++) {
+        size_t first;
+        size_t count;
+        getRoundGames(round, &first, &count);
+        for (size_t one = first; one < first + count; one++) {
+            for (size_t two = one + 1; two < first + count; two++) {
+                _game_pairs.push_back(std::make_pair(one, two));
+            }
+        }
+    }
+}
+
+bool SwapMoveGenerator::generate(Random& random, Move* out_move)
+{
+    if (_game_pairs.empty()) {
+        return false;
+    }
+
+    // games of the same round never share players, so the check passes unless rounds overlap
+    const auto& pair = _game_pairs[random.generateNumber(static_cast<uint32_t>(_game_pairs.size()))];
+    uint32_t num_seats = static_cast<uint32_t>(_schedule.config().numSeats());
+    seat_t seat_one = static_cast<seat_t>(random.generateNumber(num_seats));
+    seat_t seat_two = static_cast<seat_t>(random.generateNumber(num_seats));
+
+    const auto& games = _schedule.games();
+    player_t player_one = games[pair.first].getPlayerAtSeat(seat_one);
+    player_t player_two = games[pair.second].getPlayerAtSeat(seat_two);
+    if (!_schedule.canSwitchPlayers(player_one, pair.first, player_two, pair.second)) {
+        return false;
+    }
+
+    out_move->kind = Move::Kind::Swap;
+    out_move->substitutions.clear();
+    out_move->substitutions.push_back({ pair.first, seat_one, player_two });
+    out_move->substitutions.push_back({ pair.second, seat_two, player_one });
+    return true;
+}
+
+CycleMoveGenerator::CycleMoveGenerator(const Schedule& schedule)
+    : MoveGenerator(schedule)
+{
+    for (size_t round = 0; round < schedule.config().numRounds(); round++) {
+        size_t first;
+        size_t count;
+        getRoundGames(round, &first, &count);
+        if (count >= 3) {
+            _rounds.push_back(round);
+        }
+    }
+}
+
+bool CycleMoveGenerator::generate(Random& random, Move* out_move)
+{
+    if (_rounds.empty()) {
+        return false;
+    }
+
+    size_t first;
+    size_t count;
+    getRoundGames(_rounds[random.generateNumber(static_cast<uint32_t>(_rounds.size()))], &first, &count);
+
+    // three different games of the round
+    size_t game[3];
+    game[0] = first + random.generateNumber(static_cast<uint32_t>(count));
+    game[1] = first + (game[0] - first + 1 + random.generateNumber(static_cast<uint32_t>(count - 1))) % count;
+    do {
+        game[2] = first + random.generateNumber(static_cast<uint32_t>(count));
+    } while (game[2] == game[0] || game[2] == game[1]);
+
+    uint32_t num_seats = static_cast<uint32_t>(_schedule.config().numSeats());
+    seat_t seat[3];
+    player_t player[3];
+    for (size_t i = 0; i < 3; i++) {
+        seat[i] = static_cast<seat_t>(random.generateNumber(num_seats));
+        player[i] = _schedule.games()[game[i]].getPlayerAtSeat(seat[i]);
+    }
+
+    // the player of game i moves to game i + 1
+    out_move->kind = Move::Kind::Cycle;
+    out_move->substitutions.clear();
+    for (size_t i = 0; i < 3; i++) {
+        size_t from = (i + 2) % 3;
+        if (_schedule.participates(game[i], player[from])) {
+            return false;
+        }
+        out_move->substitutions.push_back({ game[i], seat[i], player[from] });
+    }
+    return true;
+}
+
+ExchangeMoveGenerator::ExchangeMoveGenerator(const Schedule& schedule)
+    : MoveGenerator(schedule)
+{
+}
+
+bool ExchangeMoveGenerator::generate(Random& random, Move* out_move)
+{
+    const auto& conf = _schedule.config();
+    player_t player_a = static_cast<player_t>(random.generateNumber(static_cast<uint32_t>(conf.numPlayers())));
+    player_t player_b = static_cast<player_t>(random.generateNumber(static_cast<uint32_t>(conf.numPlayers())));
+    if (player_a == player_b) {
+        return false;
+    }
+
+    // random range of rounds
+    uint32_t num_rounds = static_cast<uint32_t>(conf.numRounds());
+    size_t length = 1 + random.generateNumber(num_rounds);
+    size_t start = random.generateNumber(static_cast<uint32_t>(num_rounds - length + 1));
+
+    out_move->kind = Move::Kind::Exchange;
+    out_move->substitutions.clear();
+    for (size_t round = start; round < start + length; round++) {
+        size_t game_a;
+        size_t game_b;
+        seat_t seat_a;
+        seat_t seat_b;
+        bool plays_a = _schedule.findPlayer(round, player_a, &game_a, &seat_a);
+        bool plays_b = _schedule.findPlayer(round, player_b, &game_b, &seat_b);
+
+        // the range ends where only one of them plays, otherwise a game moves
+        // from one player to the other and the numbers of games differ
+        if (plays_a != plays_b)
+            break;
+
+        // substitutions of the same game go one after another
+        if (plays_a) {
+            out_move->substitutions.push_back({ game_a, seat_a, player_b });
+            out_move->substitutions.push_back({ game_b, seat_b, player_a });
+        }
+    }
+
+    return !out_move->substitutions.empty();
+}
+
+MoveMix::MoveMix(const Schedule& schedule, const MoveWeights& weights)
+    : MoveGenerator(schedule)
+    , _total_weight(0.0)
+{
+    if (weights.swap > 0) {
+        _generators.push_back(std::make_unique<SwapMoveGenerator>(schedule));
+        _weights.push_back(weights.swap);
+    }
+
+    if (weights.cycle > 0) {
+        _generators.push_back(std::make_unique<CycleMoveGenerator>(schedule));
+        _weights.push_back(weights.cycle);
+    }
+
+    if (weights.exchange > 0) {
+        _generators.push_back(std::make_unique<ExchangeMoveGenerator>(schedule));
+        _weights.push_back(weights.exchange);
+    }
+
+    for (auto weight : _weights) {
+        _total_weight += weight;
+    }
+
+    assert(!_generators.empty());
+}
+
+bool MoveMix::generate(Random& random, Move* out_move)
+{
+    // a single generator does not spend random numbers on the choice
+    if (_generators.size() == 1) {
+        return _generators[0]->generate(random, out_move);
+    }
+
+    double value = random.generateProbability() * _total_weight;
+    size_t idx = 0;
+    while (idx + 1 < _weights.size() && value >= _weights[idx]) {
+        value -= _weights[idx];
+        idx++;
+    }
+
+    return _generators[idx]->generate(random, out_move);
+}
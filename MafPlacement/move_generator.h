@@ -0,0 +1,146 @@
+#pragma once
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "random.h"
+#include "schedule.h"
+
+//
+// struct Move - a change of players at some seats of a schedule.
+// Every substitution puts a player to a seat of a game;
+// substitutions of the same game go one after another.
+// The object is reused between probes, so its buffer is not reallocated.
+//
+struct Move
+{
+    enum class Kind
+    {
+        Swap,       // two players of two games of the same round switch their places
+        Cycle,      // three players of three games of the same round rotate
+        Exchange,   // two players exchange their places in a range of rounds
+    };
+
+    struct Substitution
+    {
+        size_t game;
+        seat_t seat;
+        player_t player;
+    };
+
+    Kind kind;
+    std::vector<Substitution> substitutions;
+};
+
+// weights of move kinds, a kind with zero weight is never generated
+struct MoveWeights
+{
+    double swap;
+    double cycle;
+    double exchange;
+
+    // the classic move: only swaps of two players
+    static MoveWeights swaps()
+    {
+        return{ 1.0, 0.0, 0.0 };
+    }
+
+    // only swaps are generated, see SwapMoves
+    bool isSwapsOnly() const
+    {
+        return swap > 0 && cycle <= 0 && exchange <= 0;
+    }
+};
+
+//
+// class MoveGenerator - generates random valid moves of a given kind
+//
+class MoveGenerator
+{
+public:
+    MoveGenerator(const Schedule& schedule)
+        : _schedule(schedule)
+    {}
+
+    virtual ~MoveGenerator() = default;
+
+public:
+    // fills a random move, returns false if no valid move is found
+    virtual bool generate(Random& random, Move* out_move) = 0;
+
+protected:
+    // range of games of the round: [first, first + count)
+    void getRoundGames(size_t round, size_t* out_first, size_t* out_count) const;
+
+protected:
+    const Schedule& _schedule;
+};
+
+//
+// class SwapMoveGenerator - switches two players of two games of the same round.
+// Pairs of games are precomputed, so a valid swap is sampled directly.
+//
+class SwapMoveGenerator : public MoveGenerator
+{
+public:
+    SwapMoveGenerator(const Schedule& schedule);
+
+    // the same signature as MoveMix, weights are not used
+    SwapMoveGenerator(const Schedule& schedule, const MoveWeights&)
+        : SwapMoveGenerator(schedule)
+    {}
+
+public:
+    bool generate(Random& random, Move* out_move) override;
+
+private:
+    std::vector<std::pair<size_t, size_t>> _game_pairs;
+};
+
+//
+// class CycleMoveGenerator - rotates three players of three games of the same round:
+// player of the first game takes the seat in the second one, and so on.
+//
+class CycleMoveGenerator : public MoveGenerator
+{
+public:
+    CycleMoveGenerator(const Schedule& schedule);
+
+public:
+    bool generate(Random& random, Move* out_move) override;
+
+private:
+    // rounds with at least three games
+    std::vector<size_t> _rounds;
+};
+
+//
+// class ExchangeMoveGenerator - two players exchange their places
+// (games and seats) in a random range of rounds,
+// the range is cut at the first round where only one of them plays
+//
+class ExchangeMoveGenerator : public MoveGenerator
+{
+public:
+    ExchangeMoveGenerator(const Schedule& schedule);
+
+public:
+    bool generate(Random& random, Move* out_move) override;
+};
+
+//
+// class MoveMix - picks one of the generators by weight for every move
+//
+class MoveMix : public MoveGenerator
+{
+public:
+    MoveMix(const Schedule& schedule, const MoveWeights& weights);
+
+public:
+    bool generate(Random& random, Move* out_move) override;
+
+private:
+    std::vector<std::unique_ptr<MoveGenerator>> _generators;
+    std::vector<double> _weights;
+    double _total_weight;
+};
@@ -0,0 +1,216 @@
+#pragma once
+
+#include "move_generator.h"
+#include "player_score_engine.h"
+#include "random.h"
+#include "schedule.h"
+#include "seat_score_engine.h"
+
+// what is optimized by a move
+enum class MoveTarget
+{
+    Players,    // move players between games, see MoveGenerator
+    Seats,      // switch seats inside games
+    Joint,      // both kinds of moves under one objective, see JointMoves
+};
+
+// --------------------------------------------------------------------------
+// random moves with incremental score, shared by optimizers.
+// A move is generated, its delta is evaluated and then it is applied or dropped.
+// --------------------------------------------------------------------------
+
+// moves of players between games made by Generator: MoveMix picks swaps, cycles
+// and exchanges by weight, a single generator is called without virtual dispatch.
+// Engine evaluates the player score, see BasicPlayerScoreEngine
+template <typename Generator, typename Engine = PlayerScoreEngine>
+class BasicPlayerMoves
+{
+public:
+    BasicPlayerMoves(Schedule& schedule, Random& random, const MoveWeights& weights)
+        : _random(random)
+        , _engine(schedule)
+        , _generator(schedule, weights)
+    {}
+
+    bool generate()
+    {
+        return _generator.generate(_random, &_move);
+    }
+
+    double delta() const
+    {
+        return _engine.calcMoveDelta(_move);
+    }
+
+    void apply()
+    {
+        _engine.applyMove(_move);
+    }
+
+    double score() const
+    {
+        return _engine.score();
+    }
+
+    // parts of the score, see PlayerScoreEngine
+    double sdPenalty() const
+    {
+        return _engine.sdPenalty();
+    }
+
+    double addPenalty() const
+    {
+        return _engine.addPenalty();
+    }
+
+private:
+    Random& _random;
+    Engine _engine;
+    Generator _generator;
+    Move _move;
+};
+
+typedef BasicPlayerMoves<MoveMix> PlayerMoves;
+
+// swaps only: the same moves and random numbers as PlayerMoves with MoveWeights::swaps()
+typedef BasicPlayerMoves<SwapMoveGenerator> SwapMoves;
+
+// switches of seats inside a game
+class SeatMoves
+{
+public:
+    SeatMoves(Schedule& schedule, Random& random)
+        : _schedule(schedule)
+        , _random(random)
+        , _engine(schedule)
+    {}
+
+    // the same signature as PlayerMoves, weights of player moves are not used
+    SeatMoves(Schedule& schedule, Random& random, const MoveWeights&)
+        : SeatMoves(schedule, random)
+    {}
+
+    bool generate()
+    {
+        _game = _schedule.generateRandomGame(_random);
+        _seat_one = _schedule.generateRandomSeat(_random);
+        _seat_two = _schedule.generateRandomSeat(_random);
+        return _seat_one != _seat_two;
+    }
+
+    double delta() const
+    {
+        return _engine.calcSwitchSeatsDelta(_game, _seat_one, _seat_two);
+    }
+
+    void apply()
+    {
+        _engine.switchSeats(_game, _seat_one, _seat_two);
+    }
+
+    double score() const
+    {
+        return _engine.score();
+    }
+
+    // the seat score is a square deviation only
+    double sdPenalty() const
+    {
+        return _engine.score();
+    }
+
+    double addPenalty() const
+    {
+        return 0.0;
+    }
+
+private:
+    Schedule& _schedule;
+    Random& _random;
+    SeatScoreEngine _engine;
+
+    size_t _game;
+    size_t _seat_one;
+    size_t _seat_two;
+};
+
+// moves of players between games and switches of seats inside games under one objective:
+// player score + seat_weight * seat score. Both engines follow every move,
+// so a player move is scored also by the seats the players take.
+// Half of the moves are seat switches, they are cheap and do not change meetings
+class JointMoves
+{
+public:
+    JointMoves(Schedule& schedule, Random& random, const MoveWeights& weights, double seat_weight)
+        : _schedule(schedule)
+        , _random(random)
+        , _player_engine(schedule)
+        , _seat_engine(schedule)
+        , _generator(schedule, weights)
+        , _seat_weight(seat_weight)
+        , _seat_move(false)
+    {}
+
+    bool generate()
+    {
+        _seat_move = _random.generateProbability() < 0.5;
+        if (!_seat_move) {
+            return _generator.generate(_random, &_move);
+        }
+
+        _game = _schedule.generateRandomGame(_random);
+        _seat_one = _schedule.generateRandomSeat(_random);
+        _seat_two = _schedule.generateRandomSeat(_random);
+        return _seat_one != _seat_two;
+    }
+
+    double delta() const
+    {
+        if (_seat_move) {
+            return _seat_weight * _seat_engine.calcSwitchSeatsDelta(_game, _seat_one, _seat_two);
+        }
+        return _player_engine.calcMoveDelta(_move) + _seat_weight * _seat_engine.calcMoveDelta(_move);
+    }
+
+    void apply()
+    {
+        if (_seat_move) {
+            _seat_engine.switchSeats(_game, _seat_one, _seat_two);
+            return;
+        }
+
+        // the seat engine reads the players being replaced, so it goes first
+        _seat_engine.trackMove(_move);
+        _player_engine.applyMove(_move);
+    }
+
+    double score() const
+    {
+        return _player_engine.score() + _seat_weight * _seat_engine.score();
+    }
+
+    // the seat score counts as a square deviation
+    double sdPenalty() const
+    {
+        return _player_engine.sdPenalty() + _seat_weight * _seat_engine.score();
+    }
+
+    double addPenalty() const
+    {
+        return _player_engine.addPenalty();
+    }
+
+private:
+    Schedule& _schedule;
+    Random& _random;
+    PlayerScoreEngine _player_engine;
+    SeatScoreEngine _seat_engine;
+    MoveMix _generator;
+    double _seat_weight;
+
+    bool _seat_move;
+    Move _move;
+    size_t _game;
+    size_t _seat_one;
+    size_t _seat_two;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+// --------------------------------------------------------------------------
+// portability shims: the sources use the secure CRT functions of MSVC,
+// other compilers (see MafBenchmark/CMakeLists.txt) get equivalents here
+// --------------------------------------------------------------------------
+
+#ifndef _MSC_VER
+#include <cerrno>
+#include <cstddef>
+#include <cstdio>
+
+// the size of the buffer is taken from its array type, as by the MSVC template overload
+template <size_t N, typename... Args>
+int sprintf_s(char (&buffer)[N], const char* format, Args... args)
+{
+    return snprintf(buffer, N, format, args...);
+}
+
+inline int fopen_s(FILE** out_file, const char* path, const char* mode)
+{
+    *out_file = fopen(path, mode);
+    return *out_file ? 0 : errno;
+}
+
+// only numbers are scanned, so there are no buffer sizes to pass
+#define sscanf_s sscanf
+#endif
@@ -0,0 +1,33 @@
+#include "player_bitsets.h"
+
+PlayerBitsets::PlayerBitsets(const Schedule& schedule)
+    : _schedule(schedule)
+    , _kernel(detectPopcountKernel())
+    , _and_popcount(getAndPopcount(_kernel))
+    , _rows_popcount(getRowsPopcount(_kernel))
+{
+    const size_t WORD_BITS = 64;
+    size_t num_words = (schedule.config().numGames() + WORD_BITS - 1) / WORD_BITS;
+    _num_words = (num_words + PopcountBlockWords - 1) / PopcountBlockWords * PopcountBlockWords;
+
+    reset();
+}
+
+void PlayerBitsets::reset()
+{
+    _bits.assign(_schedule.config().numPlayers() * _num_words, 0);
+
+    size_t game_idx = 0;
+    for (const auto& game : _schedule.games()) {
+        uint64_t bit = 1ULL << (game_idx % 64);
+        for (auto id : game.seats()) {
+            _bits[id * _num_words + game_idx / 64] |= bit;
+        }
+        game_idx++;
+    }
+}
+
+void PlayerBitsets::calcOpponents(player_t player_id, int* out_opponents) const
+{
+    _rows_popcount(row(player_id), _bits.data(), _schedule.config().numPlayers(), _num_words, out_opponents);
+}
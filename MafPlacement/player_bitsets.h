@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "popcount.h"
+#include "schedule.h"
+
+//
+// class PlayerBitsets - games of every player as a bitset over games.
+// Number of meetings of two players is popcount(games_a & games_b),
+// so opponent histograms do not walk the games at all.
+//
+class PlayerBitsets
+{
+public:
+    PlayerBitsets(const Schedule& schedule);
+    ~PlayerBitsets() = default;
+
+public:
+    // rebuilds bitsets from the schedule, O(games * seats)
+    void reset();
+
+    // number of games played together by two players,
+    // number of games of the player if players are the same
+    int meetings(player_t player_a, player_t player_b) const
+    {
+        return static_cast<int>(_and_popcount(row(player_a), row(player_b), _num_words));
+    }
+
+    // fills meetings of the player with every player, size of array: number of players
+    void calcOpponents(player_t player_id, int* out_opponents) const;
+
+    // kernel used for popcount
+    PopcountKernel kernel() const
+    {
+        return _kernel;
+    }
+
+private:
+    const uint64_t* row(player_t player_id) const
+    {
+        return &_bits[player_id * _num_words];
+    }
+
+private:
+    const Schedule& _schedule;
+    PopcountKernel _kernel;
+    AndPopcountFn _and_popcount;
+    RowsPopcountFn _rows_popcount;
+
+    // 64-bit words per player, rounded up to PopcountBlockWords for vector kernels
+    size_t _num_words;
+
+    // num_players * num_words
+    std::vector<uint64_t> _bits;
+};
@@ -0,0 +1,244 @@
+#include "player_score_engine.h"
+
+#include <algorithm>
+#include <cassert>
+
+template <typename PairPenalty>
+BasicPlayerScoreEngine<PairPenalty>::BasicPlayerScoreEngine(Schedule& schedule)
+    : _schedule(schedule)
+    , _num_players(schedule.config().numPlayers())
+    , _target(calcPlayerTarget(schedule.config()))
+{
+    reset();
+}
+
+template <typename PairPenalty>
+void BasicPlayerScoreEngine<PairPenalty>::reset()
+{
+    _meetings.assign(_num_players * _num_players, 0);
+    for (const auto& game : _schedule.games()) {
+        const auto& seats = game.seats();
+        for (size_t i = 0; i < seats.size(); i++) {
+            for (size_t j = 0; j < seats.size(); j++) {
+                if (i != j) {
+                    _meetings[seats[i] * _num_players + seats[j]]++;
+                }
+            }
+        }
+    }
+
+    _sum_meetings = 0;
+    _sum_squares = 0;
+    _sum_penalty = 0;
+    for (size_t a = 0; a < _num_players; a++) {
+        for (size_t b = 0; b < a; b++) {
+            int value = _meetings[a * _num_players + b];
+            _sum_meetings += value;
+            _sum_squares += value * value;
+            _sum_penalty += PairPenalty::penalty(value);
+        }
+    }
+}
+
+template <typename PairPenalty>
+double BasicPlayerScoreEngine<PairPenalty>::score() const
+{
+    return sdPenalty() + addPenalty();
+}
+
+template <typename PairPenalty>
+double BasicPlayerScoreEngine<PairPenalty>::sdPenalty() const
+{
+    // every unordered pair is counted twice in calcPlayerScore:
+    // sum (m - t)^2 = sum m^2 - 2 * t * sum m + pairs * t^2
+    double pairs = _num_players * (_num_players - 1) / 2.0;
+    double sd = _sum_squares - 2.0 * _target * _sum_meetings + pairs * _target * _target;
+    return 2.0 * sd / (_num_players - 1);
+}
+
+template <typename PairPenalty>
+double BasicPlayerScoreEngine<PairPenalty>::addPenalty() const
+{
+    return 2.0 * _sum_penalty;
+}
+
+template <typename PairPenalty>
+void BasicPlayerScoreEngine<PairPenalty>::calcPairChange(
+    int value, int change, int64_t* sum_squares, int64_t* sum_penalty) const
+{
+    int new_value = value + change;
+    *sum_squares += new_value * new_value - value * value;
+    *sum_penalty += PairPenalty::penalty(new_value) - PairPenalty::penalty(value);
+}
+
+template <typename PairPenalty>
+double BasicPlayerScoreEngine<PairPenalty>::calcSwitchPlayersDelta(
+    player_t player_a, size_t idx_game_a,
+    player_t player_b, size_t idx_game_b) const
+{
+    const auto& game_a = _schedule.games()[idx_game_a];
+    const auto& game_b = _schedule.games()[idx_game_b];
+    assert(_schedule.canSwitchPlayers(player_a, idx_game_a, player_b, idx_game_b));
+
+    // player_a leaves game_a and joins game_b, player_b does the opposite.
+    // A player who plays both games keeps meeting both of them.
+    const int* row_a = &_meetings[player_a * _num_players];
+    const int* row_b = &_meetings[player_b * _num_players];
+
+    int64_t sum_squares = 0;
+    int64_t sum_penalty = 0;
+    for (auto id : game_a.seats()) {
+        if (id == player_a || _schedule.participates(idx_game_b, id))
+            continue;
+        calcPairChange(row_a[id], -1, &sum_squares, &sum_penalty);
+        calcPairChange(row_b[id], +1, &sum_squares, &sum_penalty);
+    }
+
+    for (auto id : game_b.seats()) {
+        if (id == player_b || _schedule.participates(idx_game_a, id))
+            continue;
+        calcPairChange(row_a[id], +1, &sum_squares, &sum_penalty);
+        calcPairChange(row_b[id], -1, &sum_squares, &sum_penalty);
+    }
+
+    // total number of meetings does not change
+    return 2.0 * sum_squares / (_num_players - 1) + 2.0 * sum_penalty;
+}
+
+template <typename PairPenalty>
+void BasicPlayerScoreEngine<PairPenalty>::changePair(player_t player_a, player_t player_b, int change)
+{
+    auto& value = _meetings[player_a * _num_players + player_b];
+    calcPairChange(value, change, &_sum_squares, &_sum_penalty);
+    _sum_meetings += change;
+
+    value += change;
+    _meetings[player_b * _num_players + player_a] = value;
+}
+
+template <typename PairPenalty>
+void BasicPlayerScoreEngine<PairPenalty>::switchPlayers(
+    player_t player_a, size_t idx_game_a,
+    player_t player_b, size_t idx_game_b)
+{
+    const auto& game_a = _schedule.games()[idx_game_a];
+    const auto& game_b = _schedule.games()[idx_game_b];
+
+    for (auto id : game_a.seats()) {
+        if (id == player_a || _schedule.participates(idx_game_b, id))
+            continue;
+        changePair(player_a, id, -1);
+        changePair(player_b, id, +1);
+    }
+
+    for (auto id : game_b.seats()) {
+        if (id == player_b || _schedule.participates(idx_game_a, id))
+            continue;
+        changePair(player_a, id, +1);
+        changePair(player_b, id, -1);
+    }
+
+    _schedule.switchPlayers(player_a, idx_game_a, player_b, idx_game_b);
+}
+
+template <typename PairPenalty>
+void BasicPlayerScoreEngine<PairPenalty>::collectPairChanges(const Move& move) const
+{
+    _pair_changes.clear();
+
+    const auto& games = _schedule.games();
+    auto add_pair = [this](player_t a, player_t b, int change) {
+        if (a > b)
+            std::swap(a, b);
+        _pair_changes.push_back(std::make_pair(a * _num_players + b, change));
+    };
+
+    // substitutions of the same game go one after another
+    const auto& substitutions = move.substitutions;
+    for (size_t first = 0; first < substitutions.size(); ) {
+        size_t game_idx = substitutions[first].game;
+        const auto& before = games[game_idx].seats();
+        _seats_after.assign(before.begin(), before.end());
+
+        size_t last = first;
+        for (; last < substitutions.size() && substitutions[last].game == game_idx; last++) {
+            _seats_after[substitutions[last].seat] = substitutions[last].player;
+        }
+        first = last;
+
+        // only pairs with a changed seat can change,
+        // a pair of two changed seats is taken once
+        for (size_t i = 0; i < before.size(); i++) {
+            if (before[i] == _seats_after[i])
+                continue;
+
+            for (size_t j = 0; j < before.size(); j++) {
+                if (j == i || (j < i && before[j] != _seats_after[j]))
+                    continue;
+                add_pair(before[i], before[j], -1);
+                add_pair(_seats_after[i], _seats_after[j], +1);
+            }
+        }
+    }
+
+    // merge changes of the same pair, e.g. a pair which only moves to another game
+    std::sort(_pair_changes.begin(), _pair_changes.end());
+    size_t size = 0;
+    for (size_t idx = 0; idx < _pair_changes.size(); idx++) {
+        if (size > 0 && _pair_changes[size - 1].first == _pair_changes[idx].first) {
+            _pair_changes[size - 1].second += _pair_changes[idx].second;
+        }
+        else {
+            _pair_changes[size++] = _pair_changes[idx];
+        }
+    }
+    _pair_changes.resize(size);
+}
+
+template <typename PairPenalty>
+double BasicPlayerScoreEngine<PairPenalty>::calcMoveDelta(const Move& move) const
+{
+    if (move.kind == Move::Kind::Swap) {
+        // player leaving the first game takes the seat in the second one
+        const auto& one = move.substitutions[0];
+        const auto& two = move.substitutions[1];
+        return calcSwitchPlayersDelta(two.player, one.game, one.player, two.game);
+    }
+
+    collectPairChanges(move);
+
+    int64_t sum_squares = 0;
+    int64_t sum_penalty = 0;
+    for (const auto& pair : _pair_changes) {
+        if (pair.second != 0) {
+            calcPairChange(_meetings[pair.first], pair.second, &sum_squares, &sum_penalty);
+        }
+    }
+
+    // total number of meetings does not change
+    return 2.0 * sum_squares / (_num_players - 1) + 2.0 * sum_penalty;
+}
+
+template <typename PairPenalty>
+void BasicPlayerScoreEngine<PairPenalty>::applyMove(const Move& move)
+{
+    if (move.kind == Move::Kind::Swap) {
+        const auto& one = move.substitutions[0];
+        const auto& two = move.substitutions[1];
+        switchPlayers(two.player, one.game, one.player, two.game);
+        return;
+    }
+
+    collectPairChanges(move);
+    for (const auto& pair : _pair_changes) {
+        if (pair.second != 0) {
+            changePair(static_cast<player_t>(pair.first / _num_players),
+                static_cast<player_t>(pair.first % _num_players), pair.second);
+        }
+    }
+
+    _schedule.applyMove(move);
+}
+
+// tables of pair penalties used by optimizers
+template class BasicPlayerScoreEngine<DefaultPairPenalty>;
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "move_generator.h"
+#include "schedule.h"
+#include "score.h"
+
+//
+// class PlayerScoreEngine - keeps a live player x player meeting matrix
+// of a schedule and evaluates the player score (see calcPlayerScore) incrementally.
+// The score is kept as integer sums over the matrix, so it never drifts.
+// All player switches must go through the engine to keep the matrix in sync.
+// PairPenalty is the table of additional pair penalties (see DefaultPairPenalty),
+// it is a template parameter, so the table is inlined into delta evaluation.
+// Members are defined in player_score_engine.cpp for the tables instantiated there.
+//
+template <typename PairPenalty>
+class BasicPlayerScoreEngine
+{
+public:
+    BasicPlayerScoreEngine(Schedule& schedule);
+    ~BasicPlayerScoreEngine() = default;
+
+public:
+    // rebuilds meeting matrix from the schedule
+    void reset();
+
+    // current score, equal to calcPlayerScore() of the schedule
+    double score() const;
+
+    // parts of the score: square deviation from target and additional pair penalties
+    double sdPenalty() const;
+    double addPenalty() const;
+
+    // number of games played together by two players
+    int meetings(player_t player_a, player_t player_b) const
+    {
+        return _meetings[player_a * _num_players + player_b];
+    }
+
+public:
+    // returns exact change of the score if players are switched,
+    // the schedule is not modified. Complexity: O(seats)
+    double calcSwitchPlayersDelta(
+        player_t player_a, size_t idx_game_a,
+        player_t player_b, size_t idx_game_b) const;
+
+    // switches players in the schedule and updates the matrix
+    void switchPlayers(
+        player_t player_a, size_t idx_game_a,
+        player_t player_b, size_t idx_game_b);
+
+    // returns exact change of the score if the move is applied,
+    // the schedule is not modified
+    double calcMoveDelta(const Move& move) const;
+
+    // applies the move to the schedule and updates the matrix
+    void applyMove(const Move& move);
+
+private:
+    // collects merged changes of pair meetings made by the move into _pair_changes
+    void collectPairChanges(const Move& move) const;
+
+    // changes of integer sums if meetings of a pair go from "value" by "change"
+    void calcPairChange(int value, int change, int64_t* sum_squares, int64_t* sum_penalty) const;
+
+    // applies change of meetings to a pair of players
+    void changePair(player_t player_a, player_t player_b, int change);
+
+private:
+    Schedule& _schedule;
+    size_t _num_players;
+    double _target;
+
+    // meetings matrix: num_players * num_players
+    std::vector<int> _meetings;
+
+    // sums over unordered pairs of players
+    int64_t _sum_meetings;
+    int64_t _sum_squares;
+    int64_t _sum_penalty;
+
+    // scratch buffers of move evaluation: (a * num_players + b, change) with a < b
+    mutable std::vector<std::pair<size_t, int>> _pair_changes;
+    mutable std::vector<player_t> _seats_after;
+};
+
+typedef BasicPlayerScoreEngine<DefaultPairPenalty> PlayerScoreEngine;
@@ -0,0 +1,250 @@
+#include "popcount.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#include <immintrin.h>
+#endif
+
+// AVX-512 intrinsics are available since Visual Studio 2017 15.3
+#if defined(_MSC_VER) && _MSC_VER >= 1911
+#define POPCOUNT_HAS_AVX512 1
+#else
+#define POPCOUNT_HAS_AVX512 0
+#endif
+
+// MSVC emits any intrinsic, other compilers need the instruction set of the function
+#ifdef _MSC_VER
+#define POPCOUNT_TARGET_AVX2
+#else
+#define POPCOUNT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+namespace {
+
+inline size_t popcount64(uint64_t x)
+{
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0f0f0f0f0f0f0f0fULL;
+    return static_cast<size_t>((x * 0x0101010101010101ULL) >> 56);
+}
+
+size_t andPopcountScalar(const uint64_t* a, const uint64_t* b, size_t num_words)
+{
+    size_t count = 0;
+    for (size_t i = 0; i < num_words; i++) {
+        count += popcount64(a[i] & b[i]);
+    }
+    return count;
+}
+
+void rowsPopcountScalar(const uint64_t* row, const uint64_t* rows,
+    size_t num_rows, size_t num_words, int* out_counts)
+{
+    for (size_t r = 0; r < num_rows; r++) {
+        out_counts[r] = static_cast<int>(andPopcountScalar(row, rows + r * num_words, num_words));
+    }
+}
+
+// popcount of every 64-bit lane: nibble lookup with vpshufb, bytes are summed by vpsadbw
+POPCOUNT_TARGET_AVX2 inline __m256i popcountLanesAvx2(__m256i v)
+{
+    const __m256i lookup = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+
+    __m256i low = _mm256_shuffle_epi8(lookup, _mm256_and_si256(v, low_mask));
+    __m256i high = _mm256_shuffle_epi8(lookup, _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask));
+    return _mm256_sad_epu8(_mm256_add_epi8(low, high), _mm256_setzero_si256());
+}
+
+POPCOUNT_TARGET_AVX2 inline size_t sumLanesAvx2(__m256i sum)
+{
+    uint64_t lanes[4];
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+    return static_cast<size_t>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+POPCOUNT_TARGET_AVX2 size_t andPopcountAvx2(const uint64_t* a, const uint64_t* b, size_t num_words)
+{
+    __m256i sum = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 4 <= num_words; i += 4) {
+        __m256i v = _mm256_and_si256(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+        sum = _mm256_add_epi64(sum, popcountLanesAvx2(v));
+    }
+
+    return sumLanesAvx2(sum) + andPopcountScalar(a + i, b + i, num_words - i);
+}
+
+POPCOUNT_TARGET_AVX2 void rowsPopcountAvx2(const uint64_t* row, const uint64_t* rows,
+    size_t num_rows, size_t num_words, int* out_counts)
+{
+    for (size_t r = 0; r < num_rows; r++) {
+        const uint64_t* other = rows + r * num_words;
+        __m256i sum = _mm256_setzero_si256();
+        for (size_t i = 0; i < num_words; i += 8) {
+            __m256i v0 = _mm256_and_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other + i)));
+            __m256i v1 = _mm256_and_si256(
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + i + 4)),
+                _mm256_loadu_si256(reinterpret_cast<const __m256i*>(other + i + 4)));
+            sum = _mm256_add_epi64(sum, _mm256_add_epi64(popcountLanesAvx2(v0), popcountLanesAvx2(v1)));
+        }
+        out_counts[r] = static_cast<int>(sumLanesAvx2(sum));
+    }
+}
+
+#if POPCOUNT_HAS_AVX512
+size_t andPopcountAvx512(const uint64_t* a, const uint64_t* b, size_t num_words)
+{
+    __m512i sum = _mm512_setzero_si512();
+    size_t i = 0;
+    for (; i + 8 <= num_words; i += 8) {
+        __m512i v = _mm512_and_si512(_mm512_loadu_si512(a + i), _mm512_loadu_si512(b + i));
+        sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(v));
+    }
+
+    size_t count = static_cast<size_t>(_mm512_reduce_add_epi64(sum));
+    return count + andPopcountScalar(a + i, b + i, num_words - i);
+}
+
+void rowsPopcountAvx512(const uint64_t* row, const uint64_t* rows,
+    size_t num_rows, size_t num_words, int* out_counts)
+{
+    for (size_t r = 0; r < num_rows; r++) {
+        const uint64_t* other = rows + r * num_words;
+        __m512i sum = _mm512_setzero_si512();
+        for (size_t i = 0; i < num_words; i += 8) {
+            __m512i v = _mm512_and_si512(_mm512_loadu_si512(row + i), _mm512_loadu_si512(other + i));
+            sum = _mm512_add_epi64(sum, _mm512_popcnt_epi64(v));
+        }
+        out_counts[r] = static_cast<int>(_mm512_reduce_add_epi64(sum));
+    }
+}
+#endif
+
+// cpuid of the leaf and subleaf: eax, ebx, ecx, edx
+void cpuid(int info[4], int leaf, int subleaf)
+{
+#ifdef _MSC_VER
+    __cpuidex(info, leaf, subleaf);
+#else
+    unsigned int regs[4];
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+    for (size_t i = 0; i < 4; i++) {
+        info[i] = static_cast<int>(regs[i]);
+    }
+#endif
+}
+
+// register of the state components saved by the OS
+uint64_t readXcr0()
+{
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    uint32_t low;
+    uint32_t high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<uint64_t>(high) << 32) | low;
+#endif
+}
+
+PopcountKernel detectKernel()
+{
+    int info[4];
+    cpuid(info, 0, 0);
+    int max_leaf = info[0];
+    if (max_leaf < 7) {
+        return PopcountKernel::Scalar;
+    }
+
+    // the OS must save AVX (and AVX-512) registers
+    cpuid(info, 1, 0);
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
+        return PopcountKernel::Scalar;
+    }
+    uint64_t xcr0 = readXcr0();
+
+    cpuid(info, 7, 0);
+    bool avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x06) == 0x06;
+    bool avx512 = (info[1] & (1 << 16)) != 0 && (info[2] & (1 << 14)) != 0 && (xcr0 & 0xe6) == 0xe6;
+
+    if (avx512 && POPCOUNT_HAS_AVX512) {
+        return PopcountKernel::Avx512;
+    }
+
+    return avx2 ? PopcountKernel::Avx2 : PopcountKernel::Scalar;
+}
+
+} // namespace
+
+PopcountKernel detectPopcountKernel()
+{
+    static const PopcountKernel kernel = detectKernel();
+    return kernel;
+}
+
+const char* getPopcountKernelName(PopcountKernel kernel)
+{
+    switch (kernel) {
+    case PopcountKernel::Avx512:
+        return "avx512";
+    case PopcountKernel::Avx2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+AndPopcountFn getAndPopcount(PopcountKernel kernel)
+{
+    PopcountKernel best = detectPopcountKernel();
+    if (kernel > best) {
+        kernel = best;
+    }
+
+    switch (kernel) {
+#if POPCOUNT_HAS_AVX512
+    case PopcountKernel::Avx512:
+        return andPopcountAvx512;
+#endif
+    case PopcountKernel::Avx2:
+        return andPopcountAvx2;
+    default:
+        return andPopcountScalar;
+    }
+}
+
+AndPopcountFn getAndPopcount()
+{
+    return getAndPopcount(detectPopcountKernel());
+}
+
+RowsPopcountFn getRowsPopcount(PopcountKernel kernel)
+{
+    PopcountKernel best = detectPopcountKernel();
+    if (kernel > best) {
+        kernel = best;
+    }
+
+    switch (kernel) {
+#if POPCOUNT_HAS_AVX512
+    case PopcountKernel::Avx512:
+        return rowsPopcountAvx512;
+#endif
+    case PopcountKernel::Avx2:
+        return rowsPopcountAvx2;
+    default:
+        return rowsPopcountScalar;
+    }
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+// --------------------------------------------------------------------------
+// popcount(a & b) over arrays of 64-bit words.
+// Kernels are vectorized with AVX2 and AVX-512 (VPOPCNTDQ),
+// the best one supported by the CPU is chosen at run time.
+// --------------------------------------------------------------------------
+
+enum class PopcountKernel
+{
+    Scalar,     // portable bit tricks, runs everywhere
+    Avx2,       // nibble lookup with vpshufb
+    Avx512,     // vpopcntq
+};
+
+// vector kernels work on blocks of 512 bits, arrays should be padded to it
+const size_t PopcountBlockWords = 8;
+
+// returns number of bits set in both arrays
+typedef size_t (*AndPopcountFn)(const uint64_t* a, const uint64_t* b, size_t num_words);
+
+// counts bits set in both the row and every one of consecutive rows,
+// num_words must be a multiple of PopcountBlockWords
+typedef void (*RowsPopcountFn)(const uint64_t* row, const uint64_t* rows,
+    size_t num_rows, size_t num_words, int* out_counts);
+
+// the best kernel supported by the CPU (and the compiler), detected once
+PopcountKernel detectPopcountKernel();
+
+const char* getPopcountKernelName(PopcountKernel kernel);
+
+// returns a kernel, an unsupported kernel falls back to the best supported one
+AndPopcountFn getAndPopcount(PopcountKernel kernel);
+
+// returns the kernel chosen by detectPopcountKernel()
+AndPopcountFn getAndPopcount();
+
+// returns a kernel, an unsupported kernel falls back to the best supported one
+RowsPopcountFn getRowsPopcount(PopcountKernel kernel);
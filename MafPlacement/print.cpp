@@ -1,10 +1,14 @@
 #include "print.h"
 
+#include <stdexcept>
+
 #include "metrics.h"
+#include "score.h"
 
 void outputPlayerMatrix(const Schedule& schedule)
 {
     Metrics metrics(schedule);
+    const auto& snapshot = metrics.snapshot();
     const auto& conf = schedule.config();
 
     printf("\nPlayer opponents:\n");
@@ -13,9 +17,7 @@ void outputPlayerMatrix(const Schedule& schedule)
         auto print_player = 1 + player;
         printf("Player %2d: ", print_player);
         
-        auto opponents = metrics.calcPlayerOpponentsHistogram(player);
-        assert(opponents.size() == conf.numPlayers());
-        
+        const int* opponents = snapshot.opponents(player);
         for (size_t i = 0; i < conf.numPlayers(); i++) {
             if (i != player)
                 printf("%3d", opponents[i]);
@@ -29,27 +31,21 @@ void outputPlayerMatrix(const Schedule& schedule)
 void outputPlayerStatistics(const Schedule& schedule)
 {
     Metrics metrics(schedule);
+    const auto& snapshot = metrics.snapshot();
     const auto& conf = schedule.config();
 
     printf("\nPlayer statistics:\n");
-    double target = 9.0 * conf.numAttempts() / (conf.numPlayers() - 1);
+    double target = calcPlayerTarget(conf);
     printf("Each player should play %2.6f times with one another\n", target);
     printf("            min  max      sd\n");
-    for (int player = 0; player < conf.numPlayers(); player++)
+    for (player_t player = 0; player < conf.numPlayers(); player++)
     {
-        auto opponents = metrics.calcPlayerOpponentsHistogram(player);
+        const auto& stats = snapshot.opponentStats(player);
 
         auto print_player = 1 + player;
         printf("Player %2d: ", print_player);
 
-        int minv = Metrics::calcMin(opponents, player);
-        int maxv = Metrics::calcMax(opponents, player);
-        double avg = Metrics::calcAverage(opponents, player);
-
-        double sd1 = Metrics::calcSquareDeviation(opponents, player);
-        //double sd2 = Metrics::calcSquareDeviation(opponents, player, target);
-
-        printf("%3d %3d        %2.6f\n", minv, maxv, sd1);
+        printf("%3d %3d        %2.6f\n", stats.min, stats.max, stats.sd);
     }
 }
 
@@ -59,12 +55,12 @@ void outputPairsHistogram(const Schedule& schedule)
     const auto& conf = schedule.config();
 
     // calc pairs histogram
+    const auto& bitsets = metrics.bitsets();
     std::vector<int> pair_histogram(conf.numAttempts() + 1, 0);
-    for (int player = 0; player < conf.numPlayers(); player++)
+    for (player_t player = 0; player < conf.numPlayers(); player++)
     {
-        auto opponents = metrics.calcPlayerOpponentsHistogram(player);
-        for (size_t i = 0; i < player; i++) {
-            auto num_games_together = opponents[i];
+        for (player_t i = 0; i < player; i++) {
+            auto num_games_together = bitsets.meetings(player, i);
             pair_histogram[num_games_together]++;
         }
     }
@@ -89,7 +85,7 @@ void outputInitial(const Schedule& schedule)
     printScheduleByPlayers(schedule);
 
     if (!schedule.verify()) {
-        throw std::exception("schedule is not valid");
+        throw std::runtime_error("schedule is not valid");
     }
 }
 
@@ -103,7 +99,7 @@ void outputPlayerOptimization(const Schedule& schedule)
     printScheduleByPlayers(schedule);
     printScheduleByPlayersCStyle(schedule);
     if (!schedule.verify()) {
-        throw std::exception("schedule is not valid");
+        throw std::runtime_error("schedule is not valid");
     }
 
     outputPlayerMatrix(schedule);
@@ -115,17 +111,18 @@ void outputPlayerOptimization(const Schedule& schedule)
 void outputSeatOptimization(const Schedule& schedule)
 {
     Metrics metrics(schedule);
+    const auto& snapshot = metrics.snapshot();
     const auto& conf = schedule.config();
 
     printf("\nPlayer seats:\n");
-    for (int player = 0; player < conf.numPlayers(); player++)
+    for (player_t player = 0; player < conf.numPlayers(); player++)
     {
-        auto seats = metrics.calcPlayerSeatsHistogram(player);
+        const int* seats = snapshot.seats(player);
 
         auto print_player = 1 + player;
         printf("Player %2d: ", print_player);
-        for (const auto& v : seats)
-            printf("%4d", v);
+        for (size_t seat = 0; seat < conf.numSeats(); seat++)
+            printf("%4d", seats[seat]);
         printf("\n");
     }
 }
@@ -140,7 +137,7 @@ void outputFinal(const Schedule& schedule)
     printScheduleByPlayers(schedule);
     printScheduleByPlayersCStyle(schedule);
     if (!schedule.verify()) {
-        throw std::exception("schedule is not valid");
+        throw std::runtime_error("schedule is not valid");
     }
 
     outputPlayerMatrix(schedule);
@@ -155,6 +152,7 @@ void printConfiguration(const Configuration& conf)
     printf("Players: %zu\n", conf.numPlayers());
     printf("Rounds: %zu\n", conf.numRounds());
     printf("Tables per round: %zu\n", conf.numTables());
+    printf("Players per game: %zu\n", conf.numSeats());
     printf("Total nunber of games: %zu\n", conf.numGames());
     printf("Number of attempts (games played by each player during tournament): %zu\n", conf.numAttempts());
 }
@@ -175,15 +173,13 @@ void printSchedulebyRounds(const Schedule& schedule)
 {
     printf("*** Schedule by rounds\n");
 
-    int round_num = 0;
     int game_num = 0;
-    for (const auto& round : schedule.rounds()) {
-        round_num++;
-        printf("* Round %2d\n", round_num);
-        for (const Game* game : round.games()) {
+    for (size_t round_idx = 0; round_idx < schedule.config().numRounds(); round_idx++) {
+        printf("* Round %2zu\n", round_idx + 1);
+        for (const auto& game : schedule.round(round_idx).games()) {
             game_num++;
             printf("Game %3d >> ", game_num);
-            printGame(*game);
+            printGame(game);
         }
         printf("\n");
     }
@@ -198,24 +194,16 @@ void printScheduleByPlayers(const Schedule& schedule)
         auto print_player = 1 + player;
         printf("* Player %3d: ", print_player);
 
-        int round_num = 0;
-        for (const auto& round : schedule.rounds()) {
-            round_num++;
-
-            int game_num = 0;
-            bool found = false;
-            for (const Game* game : round.games()) {
-                game_num++;
-                if (game->participates(player)) {
-                    // found a table and a seat for this player this round
-                    auto print_seat = 1 + game->players()[player];
-                    printf("%2d/%2d ", game_num, print_seat);
-                    found = true;
-                    break;
-                }
+        for (size_t round_idx = 0; round_idx < conf.numRounds(); round_idx++) {
+            size_t game_idx;
+            seat_t seat;
+            if (schedule.findPlayer(round_idx, player, &game_idx, &seat)) {
+                // found a table and a seat for this player this round
+                auto game_num = 1 + game_idx - schedule.round(round_idx).firstGame();
+                auto print_seat = 1 + seat;
+                printf("%2zu/%2d ", game_num, print_seat);
             }
-
-            if (!found) {
+            else {
                 // no game for this player this round
                 printf(" */*  ");
             }
@@ -235,28 +223,19 @@ void printScheduleByPlayersCStyle(const Schedule& schedule)
         printf("{");
 
         bool comma = false;
-        int round_num = 0;
-        for (const auto& round : schedule.rounds()) {
-            round_num++;
-
+        for (size_t round_idx = 0; round_idx < conf.numRounds(); round_idx++) {
             if (comma)
                 printf(",");
             comma = true;
 
-            int game_num = 0;
-            bool found = false;
-            for (const Game* game : round.games()) {
-                game_num++;
-                if (game->participates(player)) {
-                    // found a table and a seat for this player this round
-                    auto print_seat = 1 + game->players()[player];
-                    printf(" %2d", game_num);
-                    found = true;
-                    break;
-                }
+            size_t game_idx;
+            seat_t seat;
+            if (schedule.findPlayer(round_idx, player, &game_idx, &seat)) {
+                // found a table for this player this round
+                auto game_num = 1 + game_idx - schedule.round(round_idx).firstGame();
+                printf(" %2zu", game_num);
             }
-
-            if (!found) {
+            else {
                 // no game for this player this round
                 printf("  0");
             }
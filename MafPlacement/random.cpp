@@ -0,0 +1,28 @@
+#include "random.h"
+
+namespace {
+
+// splitmix64 step, used to expand seeds
+uint64_t splitMix(uint64_t* x)
+{
+    uint64_t z = (*x += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+} // namespace
+
+uint64_t Random::deriveSeed(uint64_t seed, uint64_t stream)
+{
+    uint64_t x = seed ^ splitMix(&stream);
+    return splitMix(&x);
+}
+
+void Random::setSeed(uint64_t seed)
+{
+    // state must not be all zeros, splitmix64 never gives four zeros in a row
+    for (auto& s : _state) {
+        s = splitMix(&seed);
+    }
+}
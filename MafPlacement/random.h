@@ -0,0 +1,93 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+//
+// class Random - fast pseudo-random generator for optimizers (xoshiro256**).
+// Every optimizer owns its generator, so stages running concurrently
+// do not share any state, and a run is reproducible from its seed.
+//
+class Random
+{
+public:
+    // number of 64-bit words of the generator state
+    static const size_t StateSize = 4;
+
+public:
+    Random(uint64_t seed)
+    {
+        setSeed(seed);
+    }
+
+    ~Random() = default;
+
+public:
+    // derives seed of an independent stream (e.g. a stage) from the run seed
+    static uint64_t deriveSeed(uint64_t seed, uint64_t stream);
+
+    // expands seed into generator state
+    void setSeed(uint64_t seed);
+
+    // raw state to continue the sequence later, see Checkpoint
+    void saveState(uint64_t* out_state) const
+    {
+        for (size_t i = 0; i < StateSize; i++) {
+            out_state[i] = _state[i];
+        }
+    }
+
+    void loadState(const uint64_t* state)
+    {
+        for (size_t i = 0; i < StateSize; i++) {
+            _state[i] = state[i];
+        }
+    }
+
+    // returns next 64 random bits
+    uint64_t next()
+    {
+        const uint64_t result = rotl(_state[1] * 5, 7) * 9;
+        const uint64_t t = _state[1] << 17;
+
+        _state[2] ^= _state[0];
+        _state[3] ^= _state[1];
+        _state[1] ^= _state[2];
+        _state[0] ^= _state[3];
+
+        _state[2] ^= t;
+        _state[3] = rotl(_state[3], 45);
+
+        return result;
+    }
+
+    // returns unbiased random number in range [0, bound)
+    uint32_t generateNumber(uint32_t bound)
+    {
+        // multiply-shift with rejection of the biased low part (Lemire)
+        uint64_t m = (next() >> 32) * bound;
+        uint32_t low = static_cast<uint32_t>(m);
+        if (low < bound) {
+            uint32_t threshold = (0u - bound) % bound;
+            while (low < threshold) {
+                m = (next() >> 32) * bound;
+                low = static_cast<uint32_t>(m);
+            }
+        }
+        return static_cast<uint32_t>(m >> 32);
+    }
+
+    // returns random probability in range [0, 1)
+    double generateProbability()
+    {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+private:
+    static uint64_t rotl(uint64_t x, int k)
+    {
+        return (x << k) | (x >> (64 - k));
+    }
+
+private:
+    uint64_t _state[StateSize];
+};
@@ -1,24 +1,109 @@
 #include "random_optimizer.h"
-#include "metrics.h"
+#include "moves.h"
 
 double RandomOptimizer::optimize()
 {
-    const auto& conf = _schedule.config();
+    // moves evaluate the score of the schedule, so it is restored first
+    const StageCheckpoint* resume = _checkpoint ? _checkpoint->resumeState() : nullptr;
+    if (resume) {
+        _schedule.assignSeats(resume->seats);
+        _random.loadState(resume->random_state);
+    }
 
-    // modify schedule
-    size_t num_probes = 0;
+    // the classic swaps are generated directly, a mix goes through MoveGenerator
+    if (_weights.isSwapsOnly()) {
+        SwapMoves moves(_schedule, _random, _weights);
+        return descend(moves);
+    }
+
+    PlayerMoves moves(_schedule, _random, _weights);
+    return descend(moves);
+}
+
+template <typename Moves>
+double RandomOptimizer::descend(Moves& moves)
+{
     _total_iterations = 0;
     _good_iterations = 0;
+    size_t best_iteration = 0;
+    size_t first_iteration = 0;
+
+    const StageCheckpoint* resume = _checkpoint ? _checkpoint->resumeState() : nullptr;
+    if (resume) {
+        best_iteration = static_cast<size_t>(resume->best_iteration);
+        first_iteration = static_cast<size_t>(resume->iteration);
+        _total_iterations = static_cast<size_t>(resume->total_iterations);
+        _good_iterations = static_cast<size_t>(resume->good_iterations);
+    }
+
+    // only improving moves are accepted, so the current schedule is the best one
+    auto publish = [&](size_t iteration, bool wait) {
+        _checkpoint->publish([&](StageCheckpoint* state) {
+            state->seats = _schedule.seats();
+            state->best_seats.clear();
+            state->best_score = moves.score();
+            state->iteration = iteration;
+            state->best_iteration = best_iteration;
+            state->total_iterations = _total_iterations;
+            state->good_iterations = _good_iterations;
+            _random.saveState(state->random_state);
+            state->optimizer_state.clear();
+        }, wait);
+    };
 
-    for (size_t i = 0; i < _max_iterations; i++)
+    // counters of this run, a resumed run counts from the restart
+    TelemetryCounters counters = {};
+    auto sample = [&](size_t iteration) {
+        double score = moves.score();
+        _telemetry->sample(iteration, counters, score, score, moves.sdPenalty(), moves.addPenalty());
+    };
+
+    // a schedule may start at the lower bound already
+    _stop.reportScore(moves.score());
+
+    // modify schedule
+    size_t i = first_iteration;
+    for (; i < _max_iterations; i++)
     {
-        bool success = _schedule.randomSeatChange([&]() {
-            num_probes++;
-            return _score_fn(_schedule);
-        });
-        _good_iterations += (int)success;
+        if (_stop.shouldStop(i, i - best_iteration)) {
+            if (_checkpoint) {
+                publish(i, true);
+            }
+            break;
+        }
+
+        if (_checkpoint && _checkpoint->isRequested()) {
+            publish(i, false);
+        }
+        if (_telemetry && _telemetry->isDue(i)) {
+            sample(i);
+        }
         _total_iterations++;
+        counters.probes++;
+
+        ProbeTimer timer(counters, _telemetry && StageTelemetry::isTimed(i));
+        if (!moves.generate()) {
+            counters.failed++;
+            continue;
+        }
+        timer.lap(ProbeTimer::Part::Move);
+
+        // accept only moves which improve the score
+        double delta = moves.delta();
+        timer.lap(ProbeTimer::Part::Score);
+        if (delta < 0) {
+            moves.apply();
+            timer.lap(ProbeTimer::Part::Move);
+            _good_iterations++;
+            counters.accepted++;
+            best_iteration = i;
+            _stop.reportScore(moves.score());
+        }
+    }
+
+    if (_telemetry) {
+        sample(i);
     }
 
-    return _score_fn(_schedule);
-}
\ No newline at end of file
+    return moves.score();
+}
@@ -1,23 +1,43 @@
 #pragma once
-#include <functional>
 
+#include "checkpoint_writer.h"
 #include "metrics.h"
+#include "move_generator.h"
+#include "random.h"
 #include "schedule.h"
+#include "stop_condition.h"
+#include "telemetry.h"
 
+//
+// class RandomOptimizer - optimizes players' opponents
+// by random moves of players between games (see MoveGenerator).
+// Only the moves which improve the score are accepted.
+// Score is evaluated incrementally with PlayerScoreEngine.
+// Stops early on StopCondition.
+// With a checkpoint slot the state is published on request
+// and the run continues from a published state after a restart.
+// With telemetry the counters of probes and the score are sampled to the trace.
+//
 class RandomOptimizer
 {
 public:
     RandomOptimizer(
         Schedule& schedule, 
         size_t max_iterations,
-        std::function<double(const Schedule&)> score_fn)
+        const MoveWeights& weights,
+        uint64_t seed,
+        const StopCondition& stop,
+        CheckpointSlot* checkpoint,
+        StageTelemetry* telemetry)
         : _schedule(schedule)
         , _max_iterations(max_iterations)
-        , _score_fn(score_fn)
+        , _weights(weights)
+        , _random(seed)
+        , _stop(stop)
+        , _checkpoint(checkpoint)
+        , _telemetry(telemetry)
     {}
 
-    RandomOptimizer() = default;
-
 public:
     double optimize();
 
@@ -31,10 +51,19 @@ public:
         return _good_iterations;
     }
 
+private:
+    // the loop is compiled for every kind of moves, see BasicPlayerMoves
+    template <typename Moves>
+    double descend(Moves& moves);
+
 private:
     Schedule& _schedule;
-    std::function<double(const Schedule&)> _score_fn;
     size_t _max_iterations;
+    MoveWeights _weights;
+    Random _random;
+    const StopCondition& _stop;
+    CheckpointSlot* _checkpoint;
+    StageTelemetry* _telemetry;
 
     size_t _total_iterations;
     size_t _good_iterations;
@@ -1,29 +1,37 @@
 #pragma once
-#include <vector>
 
-class Game;
+#include "game.h"
 
 //
 // class Round - represents a set of games played simultineously.
 // Therefore, each player can take part not more than in a single
 // game of given round.
+// A view of consecutive games of a schedule, does not own them.
 //
 class Round
 {
 public:
-    Round(std::vector<Game*> games)
-        : _games(games)
+    Round(size_t first_game, const GameSpan& games)
+        : _first_game(first_game)
+        , _games(games)
     {}
 
     ~Round() = default;
 
 public:
-    const std::vector<Game*> games() const
+    // index of the first game of the round in the schedule
+    size_t firstGame() const
+    {
+        return _first_game;
+    }
+
+    GameSpan games() const
     {
         return _games;
     }
     
 private:
-    std::vector<Game*> _games;
+    size_t _first_game;
+    GameSpan _games;
 
 };
@@ -1,6 +1,13 @@
 #include "schedule.h"
 
+#include <algorithm>
 #include <cassert>
+#include <stdexcept>
+
+#include "move_generator.h"
+#include "platform.h"
+#include "schedule_io.h"
+#include "zobrist.h"
 
 
 std::unique_ptr<Schedule>
@@ -12,21 +19,21 @@ Schedule::createInitialSchedule(const Configuration& conf, player_t shift_player
 
     int game_num = 0;
     player_t player_num = shift_player_num % conf.numPlayers();
-    std::vector<Game> games;
+    std::vector<std::vector<player_t>> games;
     for (int r = 0; r < conf.numRounds(); r++) {
         for (int t = 0; t < conf.numTables(); t++) {
             if (game_num++ >= conf.numGames())
                 break;
 
             // create and initialize a game
-            std::vector<player_t> seats(conf.NumSeats, InvalidPlayerId);
+            std::vector<player_t> seats(conf.numSeats(), InvalidPlayerId);
             for (size_t i = 0; i < seats.size(); i++) {
                 seats[i] = player_num;
                 num_games_played[player_num]--;
                 player_num = ++player_num % conf.numPlayers();
             }
 
-            games.emplace_back(conf, seats);
+            games.push_back(seats);
         }
     }
 
@@ -35,33 +42,30 @@ Schedule::createInitialSchedule(const Configuration& conf, player_t shift_player
 }
 
 std::unique_ptr<Schedule>
-Schedule::createCustomSchedule(const Configuration& conf, const std::vector<std::vector<player_t>>& seats)
+Schedule::createCustomSchedule(const Configuration& conf, const std::string& path)
 {
-    // TODO: here we do not check for seats - range of players, rounds, etc
-    std::vector<Game> games;
-    for (const auto& s : seats) {
-        assert(s.size() == conf.NumSeats);
-
-        auto t = s;
-        for (auto& player : t)
-            player--;
-        games.emplace_back(conf, t);
+    ScheduleData data = readSchedule(path);
+    if (data.num_players != conf.numPlayers() || data.num_rounds != conf.numRounds() ||
+        data.num_tables != conf.numTables() || data.numGames() != conf.numGames() ||
+        data.num_seats != conf.numSeats()) {
+        char msg[4096];
+        sprintf_s(msg, "Schedule %s does not match the configuration: "
+            "%zu players, %zu rounds, %zu tables, %zu games, %zu seats instead of %zu, %zu, %zu, %zu, %zu.",
+            path.c_str(), data.num_players, data.num_rounds, data.num_tables, data.numGames(), data.num_seats,
+            conf.numPlayers(), conf.numRounds(), conf.numTables(), conf.numGames(), conf.numSeats());
+        throw std::invalid_argument(msg);
     }
 
-    auto schedule = std::make_unique<Schedule>(conf, games);
-    return schedule;
+    return std::make_unique<Schedule>(conf, data.seats);
 }
 
 bool Schedule::verify() const
 {
     // calc number of games played by every player
     std::vector<int> games_played(_config.numPlayers());
-    for (const auto& game : _games)
+    for (auto id : _seats)
     {
-        for (auto id : game.seats())
-        {
-            games_played[id]++;
-        }
+        games_played[id]++;
     }
 
     bool ok = true;
@@ -86,152 +90,220 @@ bool Schedule::verify() const
     return ok;
 }
 
-Schedule::Schedule(const Configuration& config, const std::vector<Game>& games)
+Schedule::Schedule(const Configuration& config, const std::vector<std::vector<player_t>>& games)
     : _config(config)
-    , _games(std::move(games))
+    , _version(0)
 {
-    // TODO: sanity check - provided config should be the same as all the games' config!
-
-    if (_games.size() != _config.numGames()) {
+    if (games.size() != _config.numGames()) {
         char msg[4096];
         sprintf_s(msg, "Can not create a schedule, expected number of games: %zu, got %zu instead.",
-            _config.numGames(), _games.size());
+            _config.numGames(), games.size());
         throw std::invalid_argument(msg);
     }
 
-    populateRounds();
+    _seats.reserve(_config.numGames() * _config.numSeats());
+    for (const auto& seats : games) {
+        if (seats.size() != _config.numSeats()) {
+            char msg[4096];
+            sprintf_s(msg, "Can not create a game, expected number of seats %zu, got %zu instead.",
+                _config.numSeats(), seats.size());
+            throw std::invalid_argument(msg);
+        }
+
+        for (auto player_id : seats) {
+            if (player_id >= _config.numPlayers()) {
+                char msg[4096];
+                sprintf_s(msg, "Can not create a game, invalid player %d.", player_id + 1);
+                throw std::invalid_argument(msg);
+            }
+            _seats.push_back(player_id);
+        }
+    }
+
+    populatePlaces();
+    populateHash();
+}
+
+Schedule::Schedule(const Configuration& config, const std::vector<player_t>& seats)
+    : _config(config)
+    , _version(0)
+{
+    assignSeats(seats);
 }
 
 Schedule::Schedule(const Schedule& source)
     : _config(source._config)
-    , _games(source._games)
+    , _seats(source._seats)
+    , _game_hashes(source._game_hashes)
+    , _places(source._places)
+    , _hash(source._hash)
+    , _version(0)
 {
-    populateRounds();
 }
 
-void Schedule::populateRounds()
+Schedule& Schedule::operator=(const Schedule& source)
 {
-    // populate rounds
-    _rounds.clear();
-    int game_num = 0;
-    for (size_t round = 0; round < _config.numRounds(); round++) {
-        std::vector<Game*> games_in_round;
-        for (size_t table = 0; table < _config.numTables(); table++) {
-            if (game_num < _config.numGames()) {
-                games_in_round.push_back(&_games[game_num]);
-                game_num++;
+    assert(&_config == &source._config);
+    if (this == &source) {
+        return *this;
+    }
+
+    // the same configuration, so buffers are reused without allocation
+    _seats = source._seats;
+    _game_hashes = source._game_hashes;
+    _places = source._places;
+    _hash = source._hash;
+    _version++;
+    return *this;
+}
+
+void Schedule::assignSeats(const std::vector<player_t>& seats)
+{
+    if (seats.size() != _config.numGames() * _config.numSeats()) {
+        char msg[4096];
+        sprintf_s(msg, "Can not create a schedule, expected number of seats: %zu, got %zu instead.",
+            _config.numGames() * _config.numSeats(), seats.size());
+        throw std::invalid_argument(msg);
+    }
+
+    for (auto player_id : seats) {
+        if (player_id >= _config.numPlayers()) {
+            char msg[4096];
+            sprintf_s(msg, "Can not create a game, invalid player %d.", player_id + 1);
+            throw std::invalid_argument(msg);
+        }
+    }
+
+    _seats = seats;
+    populatePlaces();
+    populateHash();
+    _version++;
+}
+
+void Schedule::populatePlaces()
+{
+    _places.assign(_config.numPlayers() * _config.numRounds(), Place{ 0, InvalidSeatId });
+    for (size_t game_idx = 0; game_idx < _config.numGames(); game_idx++) {
+        size_t round = gameRound(game_idx);
+        const player_t* seats = &_seats[game_idx * _config.numSeats()];
+        for (size_t seat = 0; seat < _config.numSeats(); seat++) {
+            auto& place = _places[seats[seat] * _config.numRounds() + round];
+            if (place.seat != InvalidSeatId) {
+                char msg[4096];
+                sprintf_s(msg, "Can not create a schedule, player %d plays twice in round %zu.",
+                    seats[seat] + 1, round + 1);
+                throw std::invalid_argument(msg);
             }
+
+            place.game = static_cast<uint32_t>(game_idx);
+            place.seat = static_cast<seat_t>(seat);
         }
-        Round r(games_in_round);
-        _rounds.push_back(std::move(r));
     }
 }
-size_t Schedule::generateRandomRound() const
+
+void Schedule::populateHash()
+{
+    _game_hashes.resize(_config.numGames());
+    _hash = 0;
+    for (size_t idx = 0; idx < _config.numGames(); idx++) {
+        _game_hashes[idx] = Game::calcHash(&_seats[idx * _config.numSeats()], _config.numSeats());
+        _hash ^= zobristGameKey(idx, _game_hashes[idx]);
+    }
+}
+
+size_t Schedule::generateRandomRound(Random& random) const
 {
     assert(_config.numRounds() >= 2);
 
-    size_t round = rand() % _config.numRounds();
+    size_t round = random.generateNumber(static_cast<uint32_t>(_config.numRounds()));
     
     // TODO: move it into special constraint/function
     // do not return a round with a single game...
-    if (_rounds[round].games().size() < 2) {
+    if (this->round(round).games().size() < 2) {
         round--;
-        assert(_rounds[round].games().size() < 2);
+        assert(this->round(round).games().size() >= 2);
     }
 
     return round;
 }
 
-size_t Schedule::generateRandomGame() const
+size_t Schedule::generateRandomGame(Random& random) const
 {
     assert(_config.numGames() >= 2);
 
-    size_t game = rand() % _config.numGames();
+    size_t game = random.generateNumber(static_cast<uint32_t>(_config.numGames()));
     return game;
 }
 
-void Schedule::generateRandomGames(size_t round, size_t* out_game_one, size_t* out_game_two) const
+void Schedule::generateRandomGames(Random& random, size_t round, size_t* out_game_one, size_t* out_game_two) const
 {
-    size_t game_low = round * _config.numTables();
-    size_t game_high = (round + 1 < _config.numRounds())
-        ? (round + 1) * _config.numTables()
-        : _config.numGames();
-
-    size_t games_in_round = game_high - game_low;
+    size_t game_low = this->round(round).firstGame();
+    size_t games_in_round = this->round(round).games().size();
     assert(games_in_round >= 2);
 
-    size_t game_shift_one = rand() % games_in_round;
-    size_t game_add_two = 1 + (rand() % (games_in_round - 1));
+    size_t game_shift_one = random.generateNumber(static_cast<uint32_t>(games_in_round));
+    size_t game_add_two = 1 + random.generateNumber(static_cast<uint32_t>(games_in_round - 1));
     size_t game_shift_two = (game_shift_one + game_add_two) % games_in_round;
     
     *out_game_one = game_low + game_shift_one;
     *out_game_two = game_low + game_shift_two;
 }
 
-seat_t Schedule::generateRandomSeat() const
+seat_t Schedule::generateRandomSeat(Random& random) const
 {
-    seat_t seat = static_cast<seat_t>(rand() % Configuration::NumSeats);
+    seat_t seat = static_cast<seat_t>(random.generateNumber(static_cast<uint32_t>(_config.numSeats())));
     return seat;
 }
 
-player_t Schedule::generateRandomPlayer() const
+player_t Schedule::generateRandomPlayer(Random& random) const
 {
-    player_t player = static_cast<player_t>(rand() % _config.numPlayers());
+    player_t player = static_cast<player_t>(random.generateNumber(static_cast<uint32_t>(_config.numPlayers())));
     return player;
 
 }
 
-bool Schedule::randomSeatChange(std::function<double()> fn)
+bool Schedule::randomSeatChange(Random& random, std::function<double()> fn)
 {
-    auto round = generateRandomRound();
-    return randomSeatChange(fn, round);
+    return randomSeatChange<std::function<double()>>(random, fn);
 }
 
-bool Schedule::randomSeatChange(std::function<double()> fn, size_t round)
+bool Schedule::randomSeatChange(Random& random, std::function<double()> fn, size_t round)
 {
-    size_t game_one;
-    size_t game_two;
-    generateRandomGames(round, &game_one, &game_two);
-
-    return randomSeatChangeInGames(fn, game_one, game_two);
+    return randomSeatChange<std::function<double()>>(random, fn, round);
 }
 
 bool Schedule::randomSeatChangeInGames(
+    Random& random,
     std::function<double()> fn,
     size_t game1_idx,
     size_t game2_idx)
+{
+    return randomSeatChangeInGames<std::function<double()>>(random, fn, game1_idx, game2_idx);
+}
+
+bool Schedule::generateRandomSwitch(Random& random, size_t game1_idx, size_t game2_idx,
+    player_t* out_player_one, player_t* out_player_two) const
 {
     assert(game1_idx != game2_idx);
 
-    auto& g1 = _games[game1_idx];
-    auto& g2 = _games[game2_idx];
-        
+    auto g1 = games()[game1_idx];
+    auto g2 = games()[game2_idx];
+
     const int MAX_ITERATIONS = 100;
     for (size_t i = 0; i < MAX_ITERATIONS; i++) {
-        seat_t pos1 = rand() % Configuration::NumSeats;
-        seat_t pos2 = rand() % Configuration::NumSeats;
-
-        // TODO: MUST check it we try to put a player to a game where there is already a player !!!
+        seat_t pos1 = static_cast<seat_t>(random.generateNumber(static_cast<uint32_t>(_config.numSeats())));
+        seat_t pos2 = static_cast<seat_t>(random.generateNumber(static_cast<uint32_t>(_config.numSeats())));
 
-        // try to swap players
-        
         player_t player1 = g1.getPlayerAtSeat(pos1);
         player_t player2 = g2.getPlayerAtSeat(pos2);
 
-        if (canSwitchPlayers(player1, game1_idx, player2, game2_idx))
-        {
-            double score_before = fn();
-            switchPlayers(player1, game1_idx, player2, game2_idx);
-            double score_after = fn();
-            if (score_after >= score_before) {
-                switchPlayers(player2, game1_idx, player1, game2_idx);
-                return false;
-            }
+        if (canSwitchPlayers(player1, game1_idx, player2, game2_idx)) {
+            *out_player_one = player1;
+            *out_player_two = player2;
             return true;
         }
     }
 
-    // cound not found a valid pair
     return false;
 }
 
@@ -257,13 +329,13 @@ bool Schedule::randomPlayerChangeInGames(
 {
     assert(game1_idx != game2_idx);
 
-    auto& g1 = _games[game1_idx];
-    auto& g2 = _games[game2_idx];
+    auto g1 = games()[game1_idx];
+    auto g2 = games()[game2_idx];
 
     const int MAX_ITERATIONS = 100;
     for (size_t i = 0; i < MAX_ITERATIONS; i++) {
-        seat_t pos1 = rand() % Configuration::NumSeats;
-        seat_t pos2 = rand() % Configuration::NumSeats;
+        seat_t pos1 = static_cast<seat_t>(rand() % _config.numSeats());
+        seat_t pos2 = static_cast<seat_t>(rand() % _config.numSeats());
 
         // TODO: MUST check it we try to put a player to a game where there is already a player !!!
 
@@ -289,43 +361,134 @@ bool Schedule::randomPlayerChangeInGames(
     return false;
 }*/
 
+bool Schedule::participates(size_t game_idx, player_t player_id) const
+{
+    const auto& place = _places[player_id * _config.numRounds() + gameRound(game_idx)];
+    return place.seat != InvalidSeatId && place.game == game_idx;
+}
+
+seat_t Schedule::findSeat(size_t game_idx, player_t player_id) const
+{
+    const auto& place = _places[player_id * _config.numRounds() + gameRound(game_idx)];
+    return (place.game == game_idx) ? place.seat : InvalidSeatId;
+}
+
+bool Schedule::findPlayer(size_t round, player_t player_id, size_t* out_game, seat_t* out_seat) const
+{
+    const auto& place = _places[player_id * _config.numRounds() + round];
+    if (place.seat == InvalidSeatId) {
+        return false;
+    }
+
+    *out_game = place.game;
+    *out_seat = place.seat;
+    return true;
+}
+
 bool Schedule::canSwitchPlayers(
     player_t player_a, size_t idx_game_a,
     player_t player_b, size_t idx_game_b) const
 {
-    auto& game_a = _games[idx_game_a];
-    auto& game_b = _games[idx_game_b];
-    return (game_a.canSubstitutePlayer(player_a, player_b) &&
-        game_b.canSubstitutePlayer(player_b, player_a));
+    return participates(idx_game_a, player_a) && !participates(idx_game_a, player_b) &&
+        participates(idx_game_b, player_b) && !participates(idx_game_b, player_a);
+}
+
+void Schedule::putPlayerToSeat(size_t game_idx, seat_t seat_idx, player_t player_id)
+{
+    player_t& seat = _seats[game_idx * _config.numSeats() + seat_idx];
+    size_t round = gameRound(game_idx);
+
+    // the old player may already hold another seat
+    auto& old_place = _places[seat * _config.numRounds() + round];
+    if (old_place.game == game_idx && old_place.seat == seat_idx) {
+        old_place.seat = InvalidSeatId;
+    }
+
+    auto& new_place = _places[player_id * _config.numRounds() + round];
+    new_place.game = static_cast<uint32_t>(game_idx);
+    new_place.seat = seat_idx;
+
+    auto& game_hash = _game_hashes[game_idx];
+    _hash ^= zobristGameKey(game_idx, game_hash);
+    game_hash ^= zobristSeatKey(seat_idx, seat) ^ zobristSeatKey(seat_idx, player_id);
+    _hash ^= zobristGameKey(game_idx, game_hash);
+    seat = player_id;
+    _version++;
 }
 
 void Schedule::switchPlayers(
     player_t player_a, size_t idx_game_a,
     player_t player_b, size_t idx_game_b)
 {
-    auto& game_a = _games[idx_game_a];
-    auto& game_b = _games[idx_game_b];
-
     // TODO: can put into assert
     if (!canSwitchPlayers(player_a, idx_game_a, player_b, idx_game_b)) {
-        throw std::exception("can not switch players!");
+        throw std::runtime_error("can not switch players!");
     }
 
-    game_a.substitutePlayer(player_a, player_b);
-    game_b.substitutePlayer(player_b, player_a);
+    seat_t seat_a = findSeat(idx_game_a, player_a);
+    seat_t seat_b = findSeat(idx_game_b, player_b);
+    putPlayerToSeat(idx_game_a, seat_a, player_b);
+    putPlayerToSeat(idx_game_b, seat_b, player_a);
 }
 
 void Schedule::switchSeats(size_t game_idx, size_t seat_one, size_t seat_two)
 {
-    auto& game = _games[game_idx];
-    game.switchSeats(seat_one, seat_two);
-
-}
-
+    assert(seat_one < _config.numSeats());
+    assert(seat_two < _config.numSeats());
 
+    player_t* seats = &_seats[game_idx * _config.numSeats()];
+    player_t player_one = seats[seat_one];
+    player_t player_two = seats[seat_two];
 
+    size_t round = gameRound(game_idx);
+    _places[player_one * _config.numRounds() + round].seat = static_cast<seat_t>(seat_two);
+    _places[player_two * _config.numRounds() + round].seat = static_cast<seat_t>(seat_one);
 
+    auto& game_hash = _game_hashes[game_idx];
+    _hash ^= zobristGameKey(game_idx, game_hash);
+    game_hash ^= zobristSeatKey(seat_one, player_one) ^ zobristSeatKey(seat_two, player_two);
+    game_hash ^= zobristSeatKey(seat_one, player_two) ^ zobristSeatKey(seat_two, player_one);
+    _hash ^= zobristGameKey(game_idx, game_hash);
 
+    std::swap(seats[seat_one], seats[seat_two]);
+    _version++;
+}
 
+void Schedule::applyMove(const Move& move)
+{
+    assert(keepsNumGames(move));
+    for (const auto& substitution : move.substitutions) {
+        putPlayerToSeat(substitution.game, substitution.seat, substitution.player);
+    }
+}
 
+bool Schedule::keepsNumGames(const Move& move) const
+{
+    // every player who leaves a seat must take another one: the same players leave and come
+    std::vector<player_t> removed;
+    std::vector<player_t> added;
+    for (const auto& substitution : move.substitutions) {
+        removed.push_back(_seats[substitution.game * _config.numSeats() + substitution.seat]);
+        added.push_back(substitution.player);
+    }
+    std::sort(removed.begin(), removed.end());
+    std::sort(added.begin(), added.end());
+    return removed == added;
+}
 
+uint64_t Schedule::calcSwitchPlayersHash(
+    player_t player_a, size_t idx_game_a,
+    player_t player_b, size_t idx_game_b) const
+{
+    uint64_t hash_a = _game_hashes[idx_game_a];
+    uint64_t hash_b = _game_hashes[idx_game_b];
+    seat_t seat_a = findSeat(idx_game_a, player_a);
+    seat_t seat_b = findSeat(idx_game_b, player_b);
+
+    uint64_t hash = _hash;
+    hash ^= zobristGameKey(idx_game_a, hash_a) ^ zobristGameKey(idx_game_b, hash_b);
+    hash_a ^= zobristSeatKey(seat_a, player_a) ^ zobristSeatKey(seat_a, player_b);
+    hash_b ^= zobristSeatKey(seat_b, player_b) ^ zobristSeatKey(seat_b, player_a);
+    hash ^= zobristGameKey(idx_game_a, hash_a) ^ zobristGameKey(idx_game_b, hash_b);
+    return hash;
+}
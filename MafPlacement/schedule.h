@@ -1,18 +1,24 @@
 #pragma once
 
+#include <cassert>
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "configuration.h"
 #include "game.h"
+#include "random.h"
 #include "round.h"
 #include "types.h"
 
+struct Move;
+
 // 
 // class Schedule - represents a schedule of games.
 // Uses Configuration to describe a tournament (number of players, number of rounds, number of games etc).
-// Stores Games in a flat vector and grouped by Rounds.
+// Stores seats of all games in one flat array: games x Configuration::numSeats(),
+// Games and Rounds are views of this array.
 // Provides methods to modify current schedule. 
 //
 class Schedule
@@ -22,14 +28,26 @@ public:
     static std::unique_ptr<Schedule>
     createInitialSchedule(const Configuration& conf, player_t shift_player_num);
 
+    // reads a schedule from a CSV, JSON or binary file (see schedule_io.h),
+    // the schedule must be valid and match the configuration
     static std::unique_ptr<Schedule>
-    createCustomSchedule(const Configuration& conf, const std::vector<std::vector<player_t>>& games);
+    createCustomSchedule(const Configuration& conf, const std::string& path);
 
 public:
-    Schedule(const Configuration& config, const std::vector<Game>& games);
+    // games: players (zero-based) at seats of every game
+    Schedule(const Configuration& config, const std::vector<std::vector<player_t>>& games);
+
+    // seats: flat array of players (zero-based) at seats of all games, see seats()
+    Schedule(const Configuration& config, const std::vector<player_t>& seats);
     Schedule(const Schedule& source);
     ~Schedule() = default;
 
+    // copies games of a schedule with the same configuration
+    Schedule& operator=(const Schedule& source);
+
+    // replaces all seats with a flat array of the same configuration, e.g. from a checkpoint
+    void assignSeats(const std::vector<player_t>& seats);
+
 public:
     bool verify() const;
 
@@ -39,20 +57,84 @@ public:
         return _config;
     }
 
-    const std::vector<Round>& rounds() const
+    // games of the round, the last round may have less tables
+    Round round(size_t round_idx) const
+    {
+        size_t game_low = round_idx * _config.numTables();
+        size_t game_high = (round_idx + 1 < _config.numRounds())
+            ? (round_idx + 1) * _config.numTables()
+            : _config.numGames();
+        return Round(game_low, GameSpan(&_seats[game_low * _config.numSeats()], _config.numSeats(),
+            &_game_hashes[game_low], game_high - game_low));
+    }
+
+    GameSpan games() const
+    {
+        return GameSpan(_seats.data(), _config.numSeats(), _game_hashes.data(), _config.numGames());
+    }
+
+    // flat array of seats: games x seats
+    const std::vector<player_t>& seats() const
+    {
+        return _seats;
+    }
+
+    // round of the game
+    size_t gameRound(size_t game_idx) const
     {
-        return _rounds;
+        return game_idx / _config.numTables();
     }
 
-    const std::vector<Game>& games() const
+    // returns if the player plays the game, O(1)
+    bool participates(size_t game_idx, player_t player_id) const;
+
+    // returns seat of the player in the game or InvalidSeatId, O(1)
+    seat_t findSeat(size_t game_idx, player_t player_id) const;
+
+    // looks for the game and the seat of the player in the round,
+    // returns false if the player does not play the round
+    bool findPlayer(size_t round, player_t player_id, size_t* out_game, seat_t* out_seat) const;
+
+    // Zobrist hash of the schedule, updated in O(1) on every switch
+    uint64_t hash() const
     {
-        return _games;
+        return _hash;
+    }
+
+    // number of modifications, changes on every change of seats unlike the hash,
+    // so caches of the schedule use it as a key
+    uint64_t version() const
+    {
+        return _version;
     }
 
 public:
-    bool randomSeatChange(std::function<double()> fn);
-    bool randomSeatChange(std::function<double()> fn, size_t round);
-    bool randomSeatChangeInGames(std::function<double()> fn,
+    // switch a random pair of players if the score fn() goes down.
+    // ScoreFn is any callable, so the score is inlined into the probe;
+    // the overloads of std::function are type-erased wrappers
+    template <typename ScoreFn>
+    bool randomSeatChange(Random& random, const ScoreFn& fn)
+    {
+        auto round = generateRandomRound(random);
+        return randomSeatChange<ScoreFn>(random, fn, round);
+    }
+
+    template <typename ScoreFn>
+    bool randomSeatChange(Random& random, const ScoreFn& fn, size_t round)
+    {
+        size_t game_one;
+        size_t game_two;
+        generateRandomGames(random, round, &game_one, &game_two);
+
+        return randomSeatChangeInGames<ScoreFn>(random, fn, game_one, game_two);
+    }
+
+    template <typename ScoreFn>
+    bool randomSeatChangeInGames(Random& random, const ScoreFn& fn, size_t game1_idx, size_t game2_idx);
+
+    bool randomSeatChange(Random& random, std::function<double()> fn);
+    bool randomSeatChange(Random& random, std::function<double()> fn, size_t round);
+    bool randomSeatChangeInGames(Random& random, std::function<double()> fn,
         size_t game1_idx, size_t game2_idx);
 
     /*bool randomPlayerChange(std::function<double()> fn);
@@ -70,20 +152,76 @@ public:
 
     void switchSeats(size_t game_num, size_t seat_one, size_t seat_two);
 
+    // puts players to seats as described by a move, see MoveGenerator
+    void applyMove(const Move& move);
+
+    // returns hash of the schedule if players are switched
+    uint64_t calcSwitchPlayersHash(
+        player_t player_a, size_t idx_game_a,
+        player_t player_b, size_t idx_game_b) const;
+
 public:
-    // helper methods for optimizers
-    size_t generateRandomRound() const;
-    size_t generateRandomGame() const;
-    seat_t generateRandomSeat() const;
-    player_t generateRandomPlayer() const;
+    // helper methods for optimizers, random generator is owned by the optimizer
+    size_t generateRandomRound(Random& random) const;
+    size_t generateRandomGame(Random& random) const;
+    seat_t generateRandomSeat(Random& random) const;
+    player_t generateRandomPlayer(Random& random) const;
+    void generateRandomGames(Random& random, size_t round, size_t* out_game_one, size_t* out_game_two) const;
+
+    // looks for a random pair of players in two games who can be switched,
+    // returns false if no such pair is found
+    bool generateRandomSwitch(Random& random, size_t game1_idx, size_t game2_idx,
+        player_t* out_player_one, player_t* out_player_two) const;
 
 private:
-    void populateRounds();
-    void generateRandomGames(size_t round, size_t* out_game_one, size_t* out_game_two) const;
+    // place of a player in a round
+    struct Place
+    {
+        uint32_t game;
+        seat_t seat;    // InvalidSeatId if the player does not play the round
+    };
+
+    // puts the player to the seat, keeps places and hash in sync
+    void putPlayerToSeat(size_t game_idx, seat_t seat_idx, player_t player_id);
+
+    // returns if every player plays as many games after the move as before
+    bool keepsNumGames(const Move& move) const;
+
+    void populatePlaces();
+    void populateHash();
 
 private:
     const Configuration& _config;
-    std::vector<Round> _rounds;
-    std::vector<Game> _games;
+
+    // players at seats of all games: num_games * num_seats
+    std::vector<player_t> _seats;
+    std::vector<uint64_t> _game_hashes;
+
+    // player -> (game, seat) in every round: num_players * num_rounds
+    std::vector<Place> _places;
+    uint64_t _hash;
+    uint64_t _version;
 
 };
+
+template <typename ScoreFn>
+bool Schedule::randomSeatChangeInGames(Random& random, const ScoreFn& fn, size_t game1_idx, size_t game2_idx)
+{
+    assert(game1_idx != game2_idx);
+
+    player_t player1;
+    player_t player2;
+    if (!generateRandomSwitch(random, game1_idx, game2_idx, &player1, &player2)) {
+        // cound not found a valid pair
+        return false;
+    }
+
+    double score_before = fn();
+    switchPlayers(player1, game1_idx, player2, game2_idx);
+    double score_after = fn();
+    if (score_after >= score_before) {
+        switchPlayers(player2, game1_idx, player1, game2_idx);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,273 @@
+#include "schedule_builder.h"
+
+#include <algorithm>
+#include <cassert>
+#include <climits>
+
+#include "player_score_engine.h"
+#include "score.h"
+
+ScheduleBuilder::ScheduleBuilder(const Configuration& conf)
+    : _conf(conf)
+{
+}
+
+const char* ScheduleBuilder::getConstructionName(Construction construction)
+{
+    switch (construction) {
+    case Construction::Affine:
+        return "affine";
+    case Construction::Greedy:
+        return "greedy";
+    default:
+        return "sequential";
+    }
+}
+
+std::unique_ptr<Schedule> ScheduleBuilder::build(Random& random, Construction* out_construction)
+{
+    std::unique_ptr<Schedule> best_schedule;
+    double best_score = 0.0;
+    for (auto construction : { Construction::Affine, Construction::Greedy, Construction::Sequential }) {
+        auto schedule = build(construction, random);
+        if (!schedule) {
+            continue;
+        }
+
+        double score = PlayerScoreEngine(*schedule).score();
+        if (!best_schedule || score < best_score) {
+            best_schedule = std::move(schedule);
+            best_score = score;
+            if (out_construction) {
+                *out_construction = construction;
+            }
+        }
+    }
+
+    return best_schedule;
+}
+
+std::unique_ptr<Schedule> ScheduleBuilder::build(Construction construction, Random& random)
+{
+    if (construction == Construction::Sequential) {
+        return Schedule::createInitialSchedule(_conf, 0);
+    }
+
+    if (construction == Construction::Affine && !hasAffine()) {
+        return nullptr;
+    }
+
+    size_t num_players = _conf.numPlayers();
+    _meetings.assign(num_players * num_players, 0);
+    _seats.assign(num_players * _conf.numSeats(), 0);
+    _games_left.assign(num_players, static_cast<int>(_conf.numAttempts()));
+
+    Games games;
+    games.reserve(_conf.numGames());
+    if (construction == Construction::Affine) {
+        buildAffineRounds(std::min(_conf.numRounds(), _conf.numTables()), &games);
+    }
+    buildGreedyRounds(random, &games);
+
+    return std::make_unique<Schedule>(_conf, games);
+}
+
+bool ScheduleBuilder::hasAffine() const
+{
+    // all rounds are full, and rows of players differ modulo the number of tables
+    return _conf.numPlayers() == _conf.numSeats() * _conf.numTables() &&
+        _conf.numGames() == _conf.numRounds() * _conf.numTables() &&
+        _conf.numTables() >= _conf.numSeats();
+}
+
+void ScheduleBuilder::buildAffineRounds(size_t num_rounds, Games* games)
+{
+    size_t num_tables = _conf.numTables();
+    for (size_t round = 0; round < num_rounds; round++) {
+        Games round_games(num_tables, std::vector<player_t>(_conf.numSeats(), InvalidPlayerId));
+        for (size_t i = 0; i < _conf.numSeats(); i++) {
+            for (size_t j = 0; j < num_tables; j++) {
+                size_t table = (j + round * i) % num_tables;
+                size_t seat = (i + round) % _conf.numSeats();
+                round_games[table][seat] = static_cast<player_t>(i * num_tables + j);
+            }
+        }
+
+        for (const auto& game : round_games) {
+            addGame(game);
+            games->push_back(game);
+        }
+    }
+}
+
+void ScheduleBuilder::buildGreedyRounds(Random& random, Games* games)
+{
+    size_t num_players = _conf.numPlayers();
+    std::vector<player_t> players(num_players);
+    std::vector<std::vector<player_t>> tables;
+    for (size_t round = games->size() / _conf.numTables(); round < _conf.numRounds(); round++) {
+        size_t game_low = round * _conf.numTables();
+        size_t game_high = std::min(game_low + _conf.numTables(), _conf.numGames());
+        size_t num_tables = game_high - game_low;
+
+        // players with most games left play, ties are broken randomly
+        for (size_t i = 0; i < num_players; i++) {
+            players[i] = static_cast<player_t>(i);
+        }
+        for (size_t i = num_players - 1; i > 0; i--) {
+            std::swap(players[i], players[random.generateNumber(static_cast<uint32_t>(i + 1))]);
+        }
+        std::stable_sort(players.begin(), players.end(), [this](player_t a, player_t b) {
+            return _games_left[a] > _games_left[b];
+        });
+
+        // every player joins the cheapest table which is not full
+        tables.assign(num_tables, std::vector<player_t>());
+        for (size_t i = 0; i < num_tables * _conf.numSeats(); i++) {
+            player_t player = players[i];
+            size_t best_table = 0;
+            int best_cost = INT_MAX;
+            size_t shift = random.generateNumber(static_cast<uint32_t>(num_tables));
+            for (size_t t = 0; t < num_tables; t++) {
+                size_t table = (t + shift) % num_tables;
+                if (tables[table].size() == _conf.numSeats())
+                    continue;
+
+                int cost = calcJoinCost(player, tables[table]);
+                if (cost < best_cost) {
+                    best_cost = cost;
+                    best_table = table;
+                }
+            }
+            tables[best_table].push_back(player);
+        }
+
+        improveTables(&tables);
+
+        // every player takes the free seat they took the least
+        for (const auto& table : tables) {
+            std::vector<player_t> seats(_conf.numSeats(), InvalidPlayerId);
+            for (auto player : table) {
+                const int* player_seats = &_seats[player * _conf.numSeats()];
+                size_t best_seat = _conf.numSeats();
+                size_t shift = random.generateNumber(static_cast<uint32_t>(_conf.numSeats()));
+                for (size_t s = 0; s < _conf.numSeats(); s++) {
+                    size_t seat = (s + shift) % _conf.numSeats();
+                    if (seats[seat] != InvalidPlayerId)
+                        continue;
+                    if (best_seat == _conf.numSeats() || player_seats[seat] < player_seats[best_seat])
+                        best_seat = seat;
+                }
+                seats[best_seat] = player;
+            }
+
+            addGame(seats);
+            games->push_back(seats);
+        }
+    }
+
+    assert(games->size() == _conf.numGames());
+}
+
+void ScheduleBuilder::improveTables(std::vector<std::vector<player_t>>* tables)
+{
+    // late players of the greedy pass have no choice of table,
+    // so players of two tables are switched while the score goes down
+    auto& t = *tables;
+    size_t num_tables = t.size();
+
+    // costs of every player of the round at every table: (table * num_seats + position) * num_tables + table
+    _table_costs.assign(num_tables * _conf.numSeats() * num_tables, 0);
+    for (size_t table = 0; table < num_tables; table++) {
+        for (size_t i = 0; i < _conf.numSeats(); i++) {
+            for (size_t other = 0; other < num_tables; other++) {
+                _table_costs[(table * _conf.numSeats() + i) * num_tables + other] =
+                    calcJoinCost(t[table][i], t[other]);
+            }
+        }
+    }
+
+    auto cost = [&](size_t table, size_t i, size_t other) -> int& {
+        return _table_costs[(table * _conf.numSeats() + i) * num_tables + other];
+    };
+
+    const size_t MAX_PASSES = 10;
+    for (size_t pass = 0; pass < MAX_PASSES; pass++) {
+        bool improved = false;
+        for (size_t table_a = 0; table_a < num_tables; table_a++) {
+            for (size_t table_b = table_a + 1; table_b < num_tables; table_b++) {
+                for (size_t i = 0; i < _conf.numSeats(); i++) {
+                    for (size_t j = 0; j < _conf.numSeats(); j++) {
+                        player_t a = t[table_a][i];
+                        player_t b = t[table_b][j];
+                        int cost_before = cost(table_a, i, table_a) + cost(table_b, j, table_b);
+                        int cost_after = cost(table_a, i, table_b) - calcJoinCost(a, b) +
+                            cost(table_b, j, table_a) - calcJoinCost(b, a);
+                        if (cost_after >= cost_before)
+                            continue;
+
+                        // costs at both tables change for all players of the round
+                        for (size_t table = 0; table < num_tables; table++) {
+                            for (size_t k = 0; k < _conf.numSeats(); k++) {
+                                player_t x = t[table][k];
+                                int change = calcJoinCost(x, b) - calcJoinCost(x, a);
+                                if (x != a && x != b) {
+                                    cost(table, k, table_a) += change;
+                                    cost(table, k, table_b) -= change;
+                                }
+                            }
+                        }
+
+                        // a and b change places, their own costs move with them
+                        for (size_t other = 0; other < num_tables; other++) {
+                            std::swap(cost(table_a, i, other), cost(table_b, j, other));
+                        }
+                        cost(table_a, i, table_a) -= calcJoinCost(b, a);
+                        cost(table_a, i, table_b) += calcJoinCost(b, a);
+                        cost(table_b, j, table_b) -= calcJoinCost(a, b);
+                        cost(table_b, j, table_a) += calcJoinCost(a, b);
+                        std::swap(t[table_a][i], t[table_b][j]);
+                        improved = true;
+                    }
+                }
+            }
+        }
+
+        if (!improved) {
+            break;
+        }
+    }
+}
+
+void ScheduleBuilder::addGame(const std::vector<player_t>& seats)
+{
+    size_t num_players = _conf.numPlayers();
+    for (size_t i = 0; i < seats.size(); i++) {
+        for (size_t j = 0; j < seats.size(); j++) {
+            if (i != j) {
+                _meetings[seats[i] * num_players + seats[j]]++;
+            }
+        }
+        _seats[seats[i] * _conf.numSeats() + i]++;
+        _games_left[seats[i]]--;
+    }
+}
+
+int ScheduleBuilder::calcJoinCost(player_t player_id, player_t other_id) const
+{
+    // change of the player score (see PlayerScoreEngine) multiplied by (num_players - 1) / 2:
+    // square deviation gives (m + 1)^2 - m^2, pair penalty is weighted by num_players - 1
+    int penalty_weight = static_cast<int>(_conf.numPlayers() - 1);
+    int value = _meetings[player_id * _conf.numPlayers() + other_id];
+    return 2 * value + 1 + penalty_weight * (calcPairPenalty(value + 1) - calcPairPenalty(value));
+}
+
+int ScheduleBuilder::calcJoinCost(player_t player_id, const std::vector<player_t>& table) const
+{
+    int cost = 0;
+    for (auto id : table) {
+        if (id != player_id)
+            cost += calcJoinCost(player_id, id);
+    }
+    return cost;
+}
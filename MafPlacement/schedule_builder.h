@@ -0,0 +1,77 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "random.h"
+#include "schedule.h"
+
+//
+// class ScheduleBuilder - constructs near-balanced initial schedules.
+// Builds every construction which exists for the configuration
+// and returns the one with the best player score:
+//  - Affine: every player plays every round (players = seats * tables, tables >= seats).
+//    Player (i, j), i < seats, j < tables, plays game (j + round * i) mod tables at seat (i + round) mod seats,
+//    so every round is a parallel class of a transversal design and
+//    two players of different rows meet at most once in "tables" rounds when tables is prime.
+//    Rounds beyond "tables" are completed by the greedy builder.
+//  - Greedy: resting players rotate round-robin (the players with most games left play),
+//    every player takes the table where they add the least to the score,
+//    then players of two tables are switched while it improves the round,
+//    and every player takes the seat they took the least.
+//  - Sequential: tables are filled by consecutive players (Schedule::createInitialSchedule).
+//
+class ScheduleBuilder
+{
+public:
+    enum class Construction
+    {
+        Sequential,
+        Affine,
+        Greedy,
+    };
+
+public:
+    ScheduleBuilder(const Configuration& conf);
+    ~ScheduleBuilder() = default;
+
+public:
+    // returns the best schedule of all constructions, random generator breaks ties of the greedy builder
+    std::unique_ptr<Schedule> build(Random& random, Construction* out_construction = nullptr);
+
+    // returns schedule of a construction, or nullptr if it does not exist for the configuration
+    std::unique_ptr<Schedule> build(Construction construction, Random& random);
+
+    static const char* getConstructionName(Construction construction);
+
+private:
+    typedef std::vector<std::vector<player_t>> Games;
+
+    bool hasAffine() const;
+
+    // fills the first rounds of the affine construction
+    void buildAffineRounds(size_t num_rounds, Games* games);
+
+    // fills the rest of the rounds greedily
+    void buildGreedyRounds(Random& random, Games* games);
+
+    // accounts a finished game in meetings, seats and games left
+    void addGame(const std::vector<player_t>& seats);
+
+    // switches players between tables of a round while the score goes down
+    void improveTables(std::vector<std::vector<player_t>>* tables);
+
+    // change of the score (scaled to integers) if the player meets another player
+    // or joins the players at a table, the player is skipped at the table
+    int calcJoinCost(player_t player_id, player_t other_id) const;
+    int calcJoinCost(player_t player_id, const std::vector<player_t>& table) const;
+
+private:
+    const Configuration& _conf;
+
+    // state of the construction
+    std::vector<int> _meetings;     // num_players * num_players
+    std::vector<int> _seats;        // num_players * num_seats
+    std::vector<int> _games_left;   // num_players
+    std::vector<int> _table_costs;  // costs of the round players at every table
+};
@@ -0,0 +1,783 @@
+#include "schedule_io.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "platform.h"
+
+namespace {
+
+const char ARCHIVE_MAGIC[8] = { 'M', 'A', 'F', 'S', 'C', 'H', 'D', 0 };
+const uint32_t ARCHIVE_VERSION = 2;
+
+std::string readText(const std::string& path)
+{
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "rb") != 0 || !file) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not open schedule file: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    std::string text;
+    char buffer[64 * 1024];
+    size_t size = 0;
+    while ((size = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, size);
+    }
+    fclose(file);
+    return text;
+}
+
+FILE* createFile(const std::string& path, const char* mode)
+{
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), mode) != 0 || !file) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not create schedule file: %s", path.c_str());
+        throw std::runtime_error(msg);
+    }
+    return file;
+}
+
+void closeFile(FILE* file, const std::string& path, bool written)
+{
+    written = (fclose(file) == 0) && written;
+    if (!written) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not write schedule file: %s", path.c_str());
+        throw std::runtime_error(msg);
+    }
+}
+
+// one-based player of a text file
+player_t parsePlayer(unsigned long value, size_t game_idx)
+{
+    if (value < 1 || value > InvalidPlayerId) {
+        static char msg[1024];
+        sprintf_s(msg, "Invalid schedule, game %zu has invalid player %lu.", game_idx + 1, value);
+        throw std::invalid_argument(msg);
+    }
+    return static_cast<player_t>(value - 1);
+}
+
+// the number of players is the highest player of the schedule
+size_t countPlayers(const std::vector<player_t>& seats)
+{
+    return seats.empty() ? 0 : *std::max_element(seats.begin(), seats.end()) + size_t(1);
+}
+
+// --------------------------------------------------------------------------
+// CSV
+// --------------------------------------------------------------------------
+
+ScheduleData readCsv(const std::string& path)
+{
+    std::string text = readText(path);
+
+    // games are placed by round and table after all lines are read
+    struct Row
+    {
+        size_t round;
+        size_t table;
+        player_t players[Configuration::MaxSeats];
+    };
+    std::vector<Row> rows;
+    size_t num_seats = 0;
+
+    size_t line_idx = 0;
+    const char* pos = text.c_str();
+    while (*pos) {
+        const char* end = strchr(pos, '\n');
+        std::string line(pos, end ? end - pos : strlen(pos));
+        pos = end ? end + 1 : pos + line.size();
+        line_idx++;
+
+        // skip empty lines and a header
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || !isdigit(static_cast<unsigned char>(line[first]))) {
+            continue;
+        }
+
+        // one value more than the largest game tells a too long line
+        unsigned long values[2 + Configuration::MaxSeats + 1];
+        const char* field = line.c_str();
+        size_t num_values = 0;
+        for (; num_values < 2 + Configuration::MaxSeats + 1; num_values++) {
+            char* field_end = nullptr;
+            values[num_values] = strtoul(field, &field_end, 10);
+            if (field_end == field) {
+                break;
+            }
+            field = field_end;
+            while (*field == ' ' || *field == '\t' || *field == ',' || *field == ';') {
+                field++;
+            }
+        }
+
+        if (num_values < 2 || !Configuration::isSupportedSeats(num_values - 2) || values[0] < 1 || values[1] < 1) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, line %zu: expected round, table and 8, 10 or 12 players.", line_idx);
+            throw std::invalid_argument(msg);
+        }
+
+        if (rows.empty()) {
+            num_seats = num_values - 2;
+        }
+        else if (num_values - 2 != num_seats) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, line %zu: %zu players instead of %zu of the first game.",
+                line_idx, num_values - 2, num_seats);
+            throw std::invalid_argument(msg);
+        }
+
+        Row row;
+        row.round = values[0] - 1;
+        row.table = values[1] - 1;
+        for (size_t seat = 0; seat < num_seats; seat++) {
+            row.players[seat] = parsePlayer(values[2 + seat], rows.size());
+        }
+        rows.push_back(row);
+    }
+
+    ScheduleData data;
+    data.num_rounds = 0;
+    data.num_tables = 0;
+    data.num_seats = num_seats;
+    for (const auto& row : rows) {
+        data.num_rounds = std::max(data.num_rounds, row.round + 1);
+        data.num_tables = std::max(data.num_tables, row.table + 1);
+    }
+
+    // games must fill rounds in order, only the last round may have less tables
+    data.seats.resize(rows.size() * num_seats);
+    for (size_t idx = 0; idx < rows.size(); idx++) {
+        const auto& row = rows[idx];
+        size_t game_idx = row.round * data.num_tables + row.table;
+        if (game_idx != idx) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, game of round %zu at table %zu is out of order.",
+                row.round + 1, row.table + 1);
+            throw std::invalid_argument(msg);
+        }
+        std::copy(row.players, row.players + num_seats, &data.seats[idx * num_seats]);
+    }
+
+    data.num_players = countPlayers(data.seats);
+    return data;
+}
+
+void writeCsv(const std::string& path, const Schedule& schedule)
+{
+    const auto& conf = schedule.config();
+    const size_t num_seats = conf.numSeats();
+    FILE* file = createFile(path, "w");
+
+    bool written = fprintf(file, "round,table") >= 0;
+    for (size_t seat = 0; seat < num_seats; seat++) {
+        written = written && fprintf(file, ",seat%zu", seat + 1) >= 0;
+    }
+    written = written && fprintf(file, "\n") >= 0;
+
+    const auto& seats = schedule.seats();
+    for (size_t game_idx = 0; game_idx < conf.numGames(); game_idx++) {
+        written = written && fprintf(file, "%zu,%zu", schedule.gameRound(game_idx) + 1,
+            game_idx % conf.numTables() + 1) >= 0;
+        for (size_t seat = 0; seat < num_seats; seat++) {
+            written = written && fprintf(file, ",%d", seats[game_idx * num_seats + seat] + 1) >= 0;
+        }
+        written = written && fprintf(file, "\n") >= 0;
+    }
+
+    closeFile(file, path, written);
+}
+
+// --------------------------------------------------------------------------
+// JSON
+// --------------------------------------------------------------------------
+
+// reads the subset of JSON used by schedules, values of unknown keys are skipped
+class JsonReader
+{
+public:
+    JsonReader(const std::string& text)
+        : _text(text)
+        , _pos(0)
+    {}
+
+    ScheduleData readSchedule()
+    {
+        ScheduleData data;
+        data.num_players = 0;
+        data.num_rounds = 0;
+        data.num_tables = 0;
+        data.num_seats = 0;
+
+        // the number of seats of the games, the key is optional
+        size_t num_seats = 0;
+
+        expect('{');
+        if (!tryConsume('}')) {
+            do {
+                std::string key = readString();
+                expect(':');
+                if (key == "players")
+                    data.num_players = readNumber();
+                else if (key == "rounds")
+                    data.num_rounds = readNumber();
+                else if (key == "tables")
+                    data.num_tables = readNumber();
+                else if (key == "seats")
+                    num_seats = readNumber();
+                else if (key == "games")
+                    readGames(&data.seats, &data.num_seats);
+                else
+                    skipValue();
+            } while (tryConsume(','));
+            expect('}');
+        }
+
+        if (num_seats != 0 && data.num_seats != 0 && num_seats != data.num_seats) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, games have %zu players instead of %zu seats.", data.num_seats, num_seats);
+            throw std::invalid_argument(msg);
+        }
+        if (data.num_seats == 0) {
+            data.num_seats = num_seats ? num_seats : Configuration::DefaultSeats;
+        }
+        return data;
+    }
+
+private:
+    // the first game defines the number of seats
+    void readGames(std::vector<player_t>* out_seats, size_t* out_num_seats)
+    {
+        expect('[');
+        if (tryConsume(']')) {
+            return;
+        }
+
+        size_t game_idx = 0;
+        do {
+            size_t num_players = 0;
+            expect('[');
+            do {
+                out_seats->push_back(parsePlayer(readNumber(), game_idx));
+                num_players++;
+            } while (tryConsume(','));
+            expect(']');
+
+            if (!Configuration::isSupportedSeats(num_players)) {
+                static char msg[1024];
+                sprintf_s(msg, "Invalid schedule, game %zu has %zu players instead of 8, 10 or 12.",
+                    game_idx + 1, num_players);
+                throw std::invalid_argument(msg);
+            }
+
+            if (game_idx == 0) {
+                *out_num_seats = num_players;
+            }
+            else if (num_players != *out_num_seats) {
+                static char msg[1024];
+                sprintf_s(msg, "Invalid schedule, game %zu has %zu players, the first game has %zu.",
+                    game_idx + 1, num_players, *out_num_seats);
+                throw std::invalid_argument(msg);
+            }
+            game_idx++;
+        } while (tryConsume(','));
+        expect(']');
+    }
+
+    unsigned long readNumber()
+    {
+        skipSpace();
+        const char* begin = _text.c_str() + _pos;
+        char* end = nullptr;
+        unsigned long value = strtoul(begin, &end, 10);
+        if (end == begin) {
+            fail("a number");
+        }
+        _pos += end - begin;
+        return value;
+    }
+
+    std::string readString()
+    {
+        expect('"');
+        std::string value;
+        while (_pos < _text.size() && _text[_pos] != '"') {
+            if (_text[_pos] == '\\') {
+                _pos++;
+            }
+            if (_pos < _text.size()) {
+                value += _text[_pos++];
+            }
+        }
+        expect('"');
+        return value;
+    }
+
+    void skipValue()
+    {
+        skipSpace();
+        char c = (_pos < _text.size()) ? _text[_pos] : 0;
+        if (c == '"') {
+            readString();
+        }
+        else if (c == '{' || c == '[') {
+            char close = (c == '{') ? '}' : ']';
+            _pos++;
+            if (tryConsume(close)) {
+                return;
+            }
+            do {
+                if (c == '{') {
+                    readString();
+                    expect(':');
+                }
+                skipValue();
+            } while (tryConsume(','));
+            expect(close);
+        }
+        else {
+            // numbers, true, false, null
+            size_t begin = _pos;
+            while (_pos < _text.size() && strchr(",}] \t\r\n", _text[_pos]) == nullptr) {
+                _pos++;
+            }
+            if (_pos == begin) {
+                fail("a value");
+            }
+        }
+    }
+
+    void skipSpace()
+    {
+        while (_pos < _text.size() && isspace(static_cast<unsigned char>(_text[_pos]))) {
+            _pos++;
+        }
+    }
+
+    bool tryConsume(char c)
+    {
+        skipSpace();
+        if (_pos < _text.size() && _text[_pos] == c) {
+            _pos++;
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c)
+    {
+        if (!tryConsume(c)) {
+            char what[4] = { '\'', c, '\'', 0 };
+            fail(what);
+        }
+    }
+
+    void fail(const char* expected)
+    {
+        static char msg[1024];
+        sprintf_s(msg, "Invalid JSON schedule, expected %s at offset %zu.", expected, _pos);
+        throw std::invalid_argument(msg);
+    }
+
+private:
+    const std::string& _text;
+    size_t _pos;
+};
+
+ScheduleData readJson(const std::string& path)
+{
+    std::string text = readText(path);
+    ScheduleData data = JsonReader(text).readSchedule();
+
+    // dimensions are optional, by default players are counted and a round is a single game
+    if (data.num_players == 0) {
+        data.num_players = countPlayers(data.seats);
+    }
+    if (data.num_tables == 0) {
+        data.num_tables = 1;
+    }
+    if (data.num_rounds == 0) {
+        data.num_rounds = (data.numGames() + data.num_tables - 1) / data.num_tables;
+    }
+    return data;
+}
+
+void writeJson(const std::string& path, const Schedule& schedule)
+{
+    const auto& conf = schedule.config();
+    FILE* file = createFile(path, "w");
+
+    const size_t num_seats = conf.numSeats();
+    bool written = fprintf(file,
+        "{\n  \"players\": %zu,\n  \"rounds\": %zu,\n  \"tables\": %zu,\n  \"seats\": %zu,\n  \"games\": [\n",
+        conf.numPlayers(), conf.numRounds(), conf.numTables(), num_seats) >= 0;
+
+    const auto& seats = schedule.seats();
+    for (size_t game_idx = 0; game_idx < conf.numGames(); game_idx++) {
+        written = written && fprintf(file, "    [") >= 0;
+        for (size_t seat = 0; seat < num_seats; seat++) {
+            written = written && fprintf(file, (seat == 0) ? "%d" : ", %d",
+                seats[game_idx * num_seats + seat] + 1) >= 0;
+        }
+        written = written && fprintf(file, (game_idx + 1 < conf.numGames()) ? "],\n" : "]\n") >= 0;
+    }
+    written = written && fprintf(file, "  ]\n}\n") >= 0;
+
+    closeFile(file, path, written);
+}
+
+// --------------------------------------------------------------------------
+// binary
+// --------------------------------------------------------------------------
+
+ScheduleArchive::Header makeHeader(const Configuration& conf, size_t num_schedules)
+{
+    ScheduleArchive::Header header;
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.version = ARCHIVE_VERSION;
+    header.num_players = static_cast<uint32_t>(conf.numPlayers());
+    header.num_rounds = static_cast<uint32_t>(conf.numRounds());
+    header.num_tables = static_cast<uint32_t>(conf.numTables());
+    header.num_games = static_cast<uint32_t>(conf.numGames());
+    header.num_schedules = static_cast<uint32_t>(num_schedules);
+    header.num_seats = static_cast<uint32_t>(conf.numSeats());
+    return header;
+}
+
+void checkHeader(const ScheduleArchive::Header& header, const std::string& path)
+{
+    if (memcmp(header.magic, ARCHIVE_MAGIC, sizeof(ARCHIVE_MAGIC)) != 0) {
+        static char msg[1024];
+        sprintf_s(msg, "Not a schedule archive: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    if (header.version != ARCHIVE_VERSION) {
+        static char msg[1024];
+        sprintf_s(msg, "Unsupported schedule archive version %u, expected %u", header.version, ARCHIVE_VERSION);
+        throw std::invalid_argument(msg);
+    }
+}
+
+// fseek takes long, which is 32-bit on Windows: archives grow beyond 2 GiB
+bool seekFile(FILE* file, int64_t offset)
+{
+#ifdef _WIN32
+    return _fseeki64(file, offset, SEEK_SET) == 0;
+#else
+    return fseeko(file, static_cast<off_t>(offset), SEEK_SET) == 0;
+#endif
+}
+
+void writeBinary(const std::string& path, const Schedule& schedule)
+{
+    FILE* file = createFile(path, "wb");
+    auto header = makeHeader(schedule.config(), 1);
+    const auto& seats = schedule.seats();
+    bool written = fwrite(&header, sizeof(header), 1, file) == 1
+        && fwrite(seats.data(), sizeof(player_t), seats.size(), file) == seats.size();
+    closeFile(file, path, written);
+}
+
+} // namespace
+
+ScheduleFormat getScheduleFormat(const std::string& path)
+{
+    size_t dot = path.find_last_of('.');
+    std::string extension = (dot == std::string::npos) ? "" : path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+
+    if (extension == "csv")
+        return ScheduleFormat::Csv;
+    if (extension == "json")
+        return ScheduleFormat::Json;
+    return ScheduleFormat::Binary;
+}
+
+ScheduleData readSchedule(const std::string& path)
+{
+    switch (getScheduleFormat(path)) {
+    case ScheduleFormat::Csv: {
+        ScheduleData data = readCsv(path);
+        validateSchedule(data);
+        return data;
+    }
+
+    case ScheduleFormat::Json: {
+        ScheduleData data = readJson(path);
+        validateSchedule(data);
+        return data;
+    }
+
+    default: {
+        ScheduleArchive archive(path);
+        if (archive.size() == 0) {
+            static char msg[1024];
+            sprintf_s(msg, "Schedule archive is empty: %s", path.c_str());
+            throw std::invalid_argument(msg);
+        }
+        return archive.read(0);
+    }
+    }
+}
+
+void writeSchedule(const std::string& path, const Schedule& schedule)
+{
+    switch (getScheduleFormat(path)) {
+    case ScheduleFormat::Csv:
+        writeCsv(path, schedule);
+        break;
+
+    case ScheduleFormat::Json:
+        writeJson(path, schedule);
+        break;
+
+    default:
+        writeBinary(path, schedule);
+        break;
+    }
+}
+
+void appendSchedule(const std::string& path, const Schedule& schedule)
+{
+    if (getScheduleFormat(path) != ScheduleFormat::Binary) {
+        static char msg[1024];
+        sprintf_s(msg, "Schedules are appended only to binary archives: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    FILE* file = nullptr;
+    if (fopen_s(&file, path.c_str(), "r+b") != 0 || !file) {
+        writeBinary(path, schedule);
+        return;
+    }
+
+    ScheduleArchive::Header header;
+    auto expected = makeHeader(schedule.config(), 0);
+    if (fread(&header, sizeof(header), 1, file) != 1) {
+        fclose(file);
+        static char msg[1024];
+        sprintf_s(msg, "Schedule archive is truncated: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    try {
+        checkHeader(header, path);
+    }
+    catch (...) {
+        fclose(file);
+        throw;
+    }
+
+    if (header.num_players != expected.num_players || header.num_rounds != expected.num_rounds ||
+        header.num_tables != expected.num_tables || header.num_games != expected.num_games ||
+        header.num_seats != expected.num_seats) {
+        fclose(file);
+        static char msg[1024];
+        sprintf_s(msg, "Schedule archive %s has another configuration.", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    // seats go to the end of the last schedule, then the count is updated
+    const auto& seats = schedule.seats();
+    int64_t offset = static_cast<int64_t>(sizeof(header))
+        + static_cast<int64_t>(header.num_schedules) * static_cast<int64_t>(seats.size() * sizeof(player_t));
+    header.num_schedules++;
+    bool written = seekFile(file, offset)
+        && fwrite(seats.data(), sizeof(player_t), seats.size(), file) == seats.size()
+        && seekFile(file, 0)
+        && fwrite(&header, sizeof(header), 1, file) == 1;
+    closeFile(file, path, written);
+}
+
+void validateSchedule(const ScheduleData& data)
+{
+    const size_t num_seats = data.num_seats;
+    if (data.num_players == 0 || data.num_rounds == 0 || data.num_tables == 0) {
+        throw std::invalid_argument("Invalid schedule, no players, rounds or tables.");
+    }
+
+    if (!Configuration::isSupportedSeats(num_seats)) {
+        static char msg[1024];
+        sprintf_s(msg, "Invalid schedule, %zu seats in a game instead of 8, 10 or 12.", num_seats);
+        throw std::invalid_argument(msg);
+    }
+
+    if (data.seats.size() % num_seats != 0) {
+        static char msg[1024];
+        sprintf_s(msg, "Invalid schedule, number of seats %zu is not a multiple of %zu.", data.seats.size(), num_seats);
+        throw std::invalid_argument(msg);
+    }
+
+    // only the last round may have less tables
+    size_t num_games = data.numGames();
+    size_t low_limit = (data.num_rounds - 1) * data.num_tables;
+    size_t high_limit = data.num_rounds * data.num_tables;
+    if (num_games <= low_limit || num_games > high_limit) {
+        static char msg[1024];
+        sprintf_s(msg, "Invalid schedule, %zu games do not fit %zu rounds of %zu tables.",
+            num_games, data.num_rounds, data.num_tables);
+        throw std::invalid_argument(msg);
+    }
+
+    // one pass: the last round of every player and its number of games
+    std::vector<uint32_t> last_round(data.num_players, 0);
+    std::vector<uint32_t> num_attempts(data.num_players, 0);
+    for (size_t idx = 0; idx < data.seats.size(); idx++) {
+        player_t player = data.seats[idx];
+        size_t game_idx = idx / num_seats;
+        if (player >= data.num_players) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, game %zu has invalid player %d.", game_idx + 1, player + 1);
+            throw std::invalid_argument(msg);
+        }
+
+        // rounds are counted from one, zero means the player has not played yet
+        uint32_t round = static_cast<uint32_t>(game_idx / data.num_tables + 1);
+        if (last_round[player] == round) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, player %d plays twice in round %u.", player + 1, round);
+            throw std::invalid_argument(msg);
+        }
+        last_round[player] = round;
+        num_attempts[player]++;
+    }
+
+    for (size_t player = 1; player < data.num_players; player++) {
+        if (num_attempts[player] != num_attempts[0]) {
+            static char msg[1024];
+            sprintf_s(msg, "Invalid schedule, player %zu plays %u games, player 1 plays %u.",
+                player + 1, num_attempts[player], num_attempts[0]);
+            throw std::invalid_argument(msg);
+        }
+    }
+}
+
+ScheduleArchive::ScheduleArchive(const std::string& path)
+    : _file(nullptr)
+    , _mapping(nullptr)
+    , _data(nullptr)
+    , _size(0)
+{
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file != INVALID_HANDLE_VALUE && GetFileSizeEx(file, &size)) {
+        _file = file;
+        _size = static_cast<size_t>(size.QuadPart);
+        _mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (_mapping) {
+            _data = static_cast<const uint8_t*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+        }
+    }
+    else if (file != INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd >= 0 && fstat(fd, &info) == 0 && info.st_size > 0) {
+        _size = static_cast<size_t>(info.st_size);
+        void* data = mmap(nullptr, _size, PROT_READ, MAP_SHARED, fd, 0);
+        _data = (data != MAP_FAILED) ? static_cast<const uint8_t*>(data) : nullptr;
+    }
+    if (fd >= 0) {
+        close(fd);
+    }
+#endif
+
+    if (!_data || _size < sizeof(Header)) {
+        unmap();
+        static char msg[1024];
+        sprintf_s(msg, "Can not map schedule archive: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+
+    _header = reinterpret_cast<const Header*>(_data);
+    _seats = reinterpret_cast<const player_t*>(_data + sizeof(Header));
+
+    try {
+        checkHeader(*_header, path);
+    }
+    catch (...) {
+        unmap();
+        throw;
+    }
+
+    if (!Configuration::isSupportedSeats(_header->num_seats)) {
+        unmap();
+        static char msg[1024];
+        sprintf_s(msg, "Schedule archive %s has %u seats in a game instead of 8, 10 or 12.", path.c_str(),
+            _header->num_seats);
+        throw std::invalid_argument(msg);
+    }
+
+    size_t schedule_size = _header->num_games * _header->num_seats * sizeof(player_t);
+    if (_header->num_schedules > (_size - sizeof(Header)) / std::max<size_t>(schedule_size, 1)) {
+        unmap();
+        static char msg[1024];
+        sprintf_s(msg, "Schedule archive is truncated: %s", path.c_str());
+        throw std::invalid_argument(msg);
+    }
+}
+
+ScheduleArchive::~ScheduleArchive()
+{
+    unmap();
+}
+
+void ScheduleArchive::unmap()
+{
+#ifdef _WIN32
+    if (_data) {
+        UnmapViewOfFile(_data);
+    }
+    if (_mapping) {
+        CloseHandle(_mapping);
+    }
+    if (_file) {
+        CloseHandle(_file);
+    }
+#else
+    if (_data) {
+        munmap(const_cast<uint8_t*>(_data), _size);
+    }
+#endif
+    _data = nullptr;
+    _mapping = nullptr;
+    _file = nullptr;
+}
+
+ScheduleData ScheduleArchive::read(size_t idx) const
+{
+    ScheduleData data;
+    data.num_players = _header->num_players;
+    data.num_rounds = _header->num_rounds;
+    data.num_tables = _header->num_tables;
+    data.num_seats = _header->num_seats;
+
+    const player_t* begin = seats(idx);
+    data.seats.assign(begin, begin + _header->num_games * _header->num_seats);
+    validateSchedule(data);
+    return data;
+}
@@ -0,0 +1,128 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "schedule.h"
+#include "types.h"
+
+// --------------------------------------------------------------------------
+// import and export of schedules.
+// CSV: a line per game "round,table,seat1,...,seatN", players are one-based,
+//      the first line may be a header.
+// JSON: {"players": 40, "rounds": 8, "tables": 4, "seats": 10, "games": [[1, 2, ...], ...]},
+//      games go in order of rounds and tables, players are one-based.
+// Text formats take the number of seats from the first game, all games must have as many players.
+// Binary: an archive of schedules of one configuration, a header (see ScheduleArchive)
+//      and zero-based seats of every schedule, which are memory-mapped on reading.
+// The format is chosen by the extension: .csv, .json, anything else is binary.
+// --------------------------------------------------------------------------
+
+enum class ScheduleFormat
+{
+    Csv,
+    Json,
+    Binary,
+};
+
+//
+// struct ScheduleData - a schedule read from a file: dimensions of the tournament
+// and flat seats (zero-based players) of games in order of rounds and tables, see Schedule::seats()
+//
+struct ScheduleData
+{
+    size_t num_players;
+    size_t num_rounds;
+    size_t num_tables;
+    size_t num_seats;
+    std::vector<player_t> seats;
+
+    size_t numGames() const
+    {
+        return seats.size() / num_seats;
+    }
+
+    // number of games of every player, the data must be valid
+    size_t numAttempts() const
+    {
+        return numGames() * num_seats / num_players;
+    }
+};
+
+ScheduleFormat getScheduleFormat(const std::string& path);
+
+// reads the first schedule of a binary archive or a schedule of a text file, the result is validated
+ScheduleData readSchedule(const std::string& path);
+
+// writes the schedule in the format of the extension, a binary file gets a single schedule
+void writeSchedule(const std::string& path, const Schedule& schedule);
+
+// appends the schedule to a binary archive of the same configuration, creates a new archive
+void appendSchedule(const std::string& path, const Schedule& schedule);
+
+// checks dimensions, range of players, a player plays once a round and all players play equal number of games.
+// One pass over seats, throws std::invalid_argument
+void validateSchedule(const ScheduleData& data);
+
+//
+// class ScheduleArchive - read-only memory-mapped binary archive of schedules.
+// Seats of a schedule are read from the mapping without copying,
+// so archives larger than memory are scanned page by page.
+// Schedules are validated on request only (see validateSchedule).
+//
+class ScheduleArchive
+{
+public:
+    // header of the file, seats of schedules follow it
+    struct Header
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t num_players;
+        uint32_t num_rounds;
+        uint32_t num_tables;
+        uint32_t num_games;
+        uint32_t num_schedules;
+        uint32_t num_seats;
+    };
+
+public:
+    explicit ScheduleArchive(const std::string& path);
+    ~ScheduleArchive();
+
+    ScheduleArchive(const ScheduleArchive&) = delete;
+    ScheduleArchive& operator=(const ScheduleArchive&) = delete;
+
+public:
+    const Header& header() const
+    {
+        return *_header;
+    }
+
+    size_t size() const
+    {
+        return _header->num_schedules;
+    }
+
+    // flat seats of the schedule: num_games x num_seats
+    const player_t* seats(size_t idx) const
+    {
+        return _seats + idx * _header->num_games * _header->num_seats;
+    }
+
+    // copies the schedule, the result is validated
+    ScheduleData read(size_t idx) const;
+
+private:
+    void unmap();
+
+private:
+    // handles of the file and the mapping on Windows
+    void* _file;
+    void* _mapping;
+    const uint8_t* _data;
+    size_t _size;
+
+    const Header* _header;
+    const player_t* _seats;
+};
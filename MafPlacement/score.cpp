@@ -0,0 +1,27 @@
+#include "score.h"
+
+int calcPairPenalty(int meetings)
+{
+    return DefaultPairPenalty::penalty(meetings);
+}
+
+double calcPlayerTarget(const Configuration& conf)
+{
+    return (conf.numSeats() - 1.0) * conf.numAttempts() / (conf.numPlayers() - 1);
+}
+
+double calcSeatTarget(const Configuration& conf)
+{
+    return conf.numAttempts() / (double)conf.numSeats();
+}
+
+// the snapshot of histograms is reused until the schedule is changed
+double calcPlayerScore(Metrics& metrics)
+{
+    return metrics.snapshot().playerScore();
+}
+
+double calcSeatScore(Metrics& metrics)
+{
+    return metrics.snapshot().seatScore();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <cassert>
+
+#include "configuration.h"
+#include "metrics.h"
+#include "schedule.h"
+
+// --------------------------------------------------------------------------
+// score functions used by optimizers (the lower the better)
+// --------------------------------------------------------------------------
+
+//
+// struct DefaultPairPenalty - additional penalty for a pair of players depending on
+// how many times they meet, number of meetings beyond the table is not penalized.
+// Score engines take the table as a template parameter, so it is inlined into their probes.
+//
+struct DefaultPairPenalty
+{
+    static int penalty(int meetings)
+    {
+        // int k[11] = { 100, 50, 0, 0, 0, 0, 20, 100, 200, 400, 800 };
+        // int k[11] = { 100, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+        // int k[11] = { 500, 100, 10, 0, 10, 50, 150, 200, 400, 800, 1000 };
+
+        static const int k[4] = { 300, 0, 0, 0 };
+        static const int k_size = sizeof(k) / sizeof(k[0]);
+
+        assert(meetings >= 0);
+        return (meetings < k_size) ? k[meetings] : 0;
+    }
+};
+
+// penalty of DefaultPairPenalty
+int calcPairPenalty(int meetings);
+
+// how many times each pair of players should meet in the ideal schedule
+double calcPlayerTarget(const Configuration& conf);
+
+// how many times each player should take every seat in the ideal schedule
+double calcSeatTarget(const Configuration& conf);
+
+// score of players' opponents distribution of the schedule of metrics
+double calcPlayerScore(Metrics& metrics);
+
+// score of players' seats distribution of the schedule of metrics
+double calcSeatScore(Metrics& metrics);
@@ -1,38 +1,132 @@
 #include "seat_optimizer.h"
 
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "seat_score_engine.h"
+#include "thread_pool.h"
+
+namespace
+{
+
+// solved seating of a game of the current round
+struct GameSeating
+{
+    size_t column[Configuration::MaxSeats];
+    int64_t sum_squares_delta;
+};
+
+}
+
 double SeatOptimizer::optimize()
 {
-    size_t div = 100;
+    SeatScoreEngine engine(_schedule);
+    const auto& config = _schedule.config();
+    const size_t num_rounds = config.numRounds();
 
-    size_t good_iterations = 0;
-    for (size_t i = 0; i < _max_iterations; i++) {
-        size_t game_idx = _schedule.generateRandomGame();
-        size_t seat_one = _schedule.generateRandomSeat();
-        size_t seat_two = _schedule.generateRandomSeat();
+    // a worker takes a slice of the games of a round, more workers than tables would idle
+    size_t num_threads = _num_threads ? _num_threads : std::thread::hardware_concurrency();
+    num_threads = std::max<size_t>(1, std::min(num_threads, config.numTables()));
+    std::unique_ptr<ThreadPool> pool;
+    if (num_threads > 1) {
+        pool = std::make_unique<ThreadPool>(num_threads);
+    }
 
-        if (seat_one == seat_two) {
-            continue;
-        }
+    // the seat score is a square deviation only.
+    // Workers count their solves apart, the counters are summed after every round
+    TelemetryCounters counters = {};
+    std::vector<TelemetryCounters> worker_counters(num_threads);
+    auto sample = [&](size_t iteration) {
+        double score = engine.score();
+        _telemetry->sample(iteration, counters, score, score, score, 0.0);
+    };
 
-        /*if ((i % div) == 0) {
-            auto score = _score_fn(_schedule);
-            printf("Iteration #%zu: score=%6.2f good iterations: %zu\n", i, score, good_iterations);
-            div *= 5;
-        }*/
+    std::vector<size_t> order(num_rounds);
+    for (size_t round = 0; round < num_rounds; round++) {
+        order[round] = round;
+    }
+    std::vector<GameSeating> seatings(config.numTables());
 
-        auto score_before = _score_fn(_schedule);
-        _schedule.switchSeats(game_idx, seat_one, seat_two);
-        auto score_after = _score_fn(_schedule);
+    size_t solves = 0;
+    size_t best_solve = 0;
+    bool improved = true;
+    bool stopped = false;
+    _stop.reportScore(engine.score());
+    while (improved && !stopped) {
+        improved = false;
 
-        if (score_after >= score_before) {
-            // roll back if score is worse than before
-            _schedule.switchSeats(game_idx, seat_two, seat_one);
+        // every sweep visits rounds in a new random order, so stages reach different fixed points.
+        // The order of games inside a round does not matter: they do not share players
+        for (size_t idx = num_rounds; idx > 1; idx--) {
+            std::swap(order[idx - 1], order[_random.generateNumber(static_cast<uint32_t>(idx))]);
         }
-        else {
-            good_iterations++;
+
+        for (size_t round_idx : order) {
+            if (solves >= _max_iterations || _stop.shouldStop(solves, solves - best_solve)) {
+                stopped = true;
+                break;
+            }
+
+            if (_telemetry && _telemetry->isDue(solves)) {
+                sample(solves);
+            }
+
+            size_t first_game = _schedule.round(round_idx).firstGame();
+            size_t num_games = std::min(_schedule.round(round_idx).games().size(), _max_iterations - solves);
+
+            // a game reads and writes only the rows of its players in the table,
+            // the schedule is read only until the round is committed
+            auto solve_slice = [&](size_t slice, size_t worker) {
+                size_t game_low = slice * num_games / num_threads;
+                size_t game_high = (slice + 1) * num_games / num_threads;
+                auto& worker_counter = worker_counters[worker];
+                for (size_t game = game_low; game < game_high; game++) {
+                    ProbeTimer timer(worker_counter, _telemetry && StageTelemetry::isTimed(solves + game));
+                    worker_counter.probes++;
+
+                    auto& seating = seatings[game];
+                    seating.sum_squares_delta = engine.solveGameSeating(first_game + game, seating.column);
+                    timer.lap(ProbeTimer::Part::Score);
+                    if (seating.sum_squares_delta < 0) {
+                        engine.reseatGameRows(first_game + game, seating.column);
+                        timer.lap(ProbeTimer::Part::Move);
+                        worker_counter.accepted++;
+                    }
+                }
+            };
+
+            if (pool) {
+                pool->run(num_threads, solve_slice);
+            }
+            else {
+                solve_slice(0, 0);
+            }
+
+            for (size_t game = 0; game < num_games; game++) {
+                const auto& seating = seatings[game];
+                if (seating.sum_squares_delta < 0) {
+                    engine.commitGameSeating(first_game + game, seating.column, seating.sum_squares_delta);
+                    best_solve = solves + game + 1;
+                    improved = true;
+                }
+            }
+            solves += num_games;
+            _stop.reportScore(engine.score());
+
+            for (auto& worker_counter : worker_counters) {
+                counters.add(worker_counter);
+                worker_counter = {};
+            }
         }
     }
 
-    auto score = _score_fn(_schedule);
+    if (_telemetry) {
+        sample(solves);
+    }
+
+    auto score = engine.score();
     return score;
-}
\ No newline at end of file
+}
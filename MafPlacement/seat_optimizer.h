@@ -1,18 +1,40 @@
 #pragma once
 
 #include "metrics.h"
+#include "random.h"
 #include "schedule.h"
+#include "stop_condition.h"
+#include "telemetry.h"
 
+//
+// class SeatOptimizer - optimizes players' seats game by game.
+// Given the other games, seating of a game is an assignment of its players to seats:
+// it is solved exactly (see SeatScoreEngine::solveGameSeating) and applied if the score goes down.
+// Sweeps go over rounds in random order until none of the games improves,
+// the number of iterations limits the number of solved games.
+// Games of a round have disjoint players, so they are solved concurrently by worker threads
+// against the shared table of SeatScoreEngine without locks; the result does not depend
+// on the number of threads.
+// Stops early on StopCondition.
+// With telemetry the counters of solves and the score are sampled to the trace.
+//
 class SeatOptimizer
 {
 public:
+    // zero number of threads means all hardware threads
     SeatOptimizer(
         Schedule& schedule,
         size_t max_iterations,
-        std::function<double(const Schedule&)> score_fn)
+        size_t num_threads,
+        uint64_t seed,
+        const StopCondition& stop,
+        StageTelemetry* telemetry)
         : _schedule(schedule)
-        , _score_fn(score_fn)
         , _max_iterations(max_iterations)
+        , _num_threads(num_threads)
+        , _random(seed)
+        , _stop(stop)
+        , _telemetry(telemetry)
     {}
 
 public:
@@ -20,6 +42,9 @@ public:
 
 private:
     Schedule& _schedule;
-    std::function<double(const Schedule&)> _score_fn;
     size_t _max_iterations;
-};
\ No newline at end of file
+    size_t _num_threads;
+    Random _random;
+    const StopCondition& _stop;
+    StageTelemetry* _telemetry;
+};
@@ -0,0 +1,212 @@
+#include "seat_score_engine.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "assignment.h"
+#include "score.h"
+
+SeatScoreEngine::SeatScoreEngine(Schedule& schedule)
+    : _schedule(schedule)
+    , _target(calcSeatTarget(schedule.config()))
+    , _num_seats(schedule.config().numSeats())
+    , _last_game(0)
+    , _last_seat_one(0)
+    , _last_seat_two(0)
+{
+    reset();
+}
+
+void SeatScoreEngine::reset()
+{
+    _seats.assign(_schedule.config().numPlayers() * _num_seats, 0);
+    for (const auto& game : _schedule.games()) {
+        const auto& players = game.seats();
+        for (size_t seat = 0; seat < players.size(); seat++) {
+            _seats[players[seat] * _num_seats + seat]++;
+        }
+    }
+
+    _sum_seats = 0;
+    _sum_squares = 0;
+    for (auto value : _seats) {
+        _sum_seats += value;
+        _sum_squares += value * value;
+    }
+}
+
+double SeatScoreEngine::score() const
+{
+    // sum (h - t)^2 = sum h^2 - 2 * t * sum h + cells * t^2
+    double cells = static_cast<double>(_seats.size());
+    double sd = _sum_squares - 2.0 * _target * _sum_seats + cells * _target * _target;
+    return sd / _num_seats;
+}
+
+double SeatScoreEngine::calcSwitchSeatsDelta(size_t game_idx, size_t seat_one, size_t seat_two) const
+{
+    assert(seat_one < _num_seats);
+    assert(seat_two < _num_seats);
+
+    if (seat_one == seat_two) {
+        return 0.0;
+    }
+
+    const auto& game = _schedule.games()[game_idx];
+    const int* row_one = &_seats[game.getPlayerAtSeat(static_cast<seat_t>(seat_one)) * _num_seats];
+    const int* row_two = &_seats[game.getPlayerAtSeat(static_cast<seat_t>(seat_two)) * _num_seats];
+
+    // (h - 1)^2 - h^2 = 1 - 2h, (h + 1)^2 - h^2 = 1 + 2h
+    int64_t sum_squares = 4 + 2 * (row_one[seat_two] - row_one[seat_one] + row_two[seat_one] - row_two[seat_two]);
+    return static_cast<double>(sum_squares) / _num_seats;
+}
+
+void SeatScoreEngine::applySwitchSeats(size_t game_idx, size_t seat_one, size_t seat_two)
+{
+    const auto& game = _schedule.games()[game_idx];
+    int* row_one = &_seats[game.getPlayerAtSeat(static_cast<seat_t>(seat_one)) * _num_seats];
+    int* row_two = &_seats[game.getPlayerAtSeat(static_cast<seat_t>(seat_two)) * _num_seats];
+
+    _sum_squares += 4 + 2 * (row_one[seat_two] - row_one[seat_one] + row_two[seat_one] - row_two[seat_two]);
+    row_one[seat_one]--;
+    row_one[seat_two]++;
+    row_two[seat_two]--;
+    row_two[seat_one]++;
+}
+
+void SeatScoreEngine::switchSeats(size_t game_idx, size_t seat_one, size_t seat_two)
+{
+    _last_game = game_idx;
+    _last_seat_one = seat_one;
+    _last_seat_two = seat_two;
+
+    if (seat_one == seat_two) {
+        return;
+    }
+
+    applySwitchSeats(game_idx, seat_one, seat_two);
+    _schedule.switchSeats(game_idx, seat_one, seat_two);
+}
+
+void SeatScoreEngine::rollback()
+{
+    // seat switch is its own inverse
+    switchSeats(_last_game, _last_seat_two, _last_seat_one);
+}
+
+void SeatScoreEngine::collectCellChanges(const Move& move) const
+{
+    // the replaced player leaves the seat, the new one takes it
+    _cell_changes.clear();
+    const auto& games = _schedule.games();
+    for (const auto& substitution : move.substitutions) {
+        player_t before = games[substitution.game].getPlayerAtSeat(substitution.seat);
+        _cell_changes.push_back(std::make_pair(before * _num_seats + substitution.seat, -1));
+        _cell_changes.push_back(std::make_pair(substitution.player * _num_seats + substitution.seat, +1));
+    }
+
+    // merge changes of the same cell, e.g. a player who keeps the seat number in another game
+    std::sort(_cell_changes.begin(), _cell_changes.end());
+    size_t size = 0;
+    for (size_t idx = 0; idx < _cell_changes.size(); idx++) {
+        if (size > 0 && _cell_changes[size - 1].first == _cell_changes[idx].first) {
+            _cell_changes[size - 1].second += _cell_changes[idx].second;
+        }
+        else {
+            _cell_changes[size++] = _cell_changes[idx];
+        }
+    }
+    _cell_changes.resize(size);
+}
+
+double SeatScoreEngine::calcMoveDelta(const Move& move) const
+{
+    collectCellChanges(move);
+
+    // total number of seats does not change
+    int64_t sum_squares = 0;
+    for (const auto& cell : _cell_changes) {
+        int value = _seats[cell.first];
+        int new_value = value + cell.second;
+        sum_squares += new_value * new_value - value * value;
+    }
+    return static_cast<double>(sum_squares) / _num_seats;
+}
+
+void SeatScoreEngine::trackMove(const Move& move)
+{
+    collectCellChanges(move);
+    for (const auto& cell : _cell_changes) {
+        int& value = _seats[cell.first];
+        int new_value = value + cell.second;
+        _sum_squares += new_value * new_value - value * value;
+        _sum_seats += cell.second;
+        value = new_value;
+    }
+}
+
+int64_t SeatScoreEngine::solveGameSeating(size_t game_idx, size_t (&out_column)[Configuration::MaxSeats]) const
+{
+    return dispatchSeats(_num_seats, [&](auto seats) {
+        return solveGameSeatingOf<decltype(seats)::value>(game_idx, out_column);
+    });
+}
+
+template <size_t N>
+int64_t SeatScoreEngine::solveGameSeatingOf(size_t game_idx, size_t (&out_column)[Configuration::MaxSeats]) const
+{
+    // (h + 1)^2 - h^2 = 2h + 1, so the change of the score is linear in
+    // the table of other games: the cost of a seat is h without this game
+    const auto& game = _schedule.games()[game_idx];
+    int cost[N][N];
+    int current = 0;
+    for (size_t from = 0; from < N; from++) {
+        const int* row = &_seats[game.getPlayerAtSeat(static_cast<seat_t>(from)) * N];
+        for (size_t seat = 0; seat < N; seat++) {
+            cost[from][seat] = row[seat] - (seat == from ? 1 : 0);
+        }
+        current += cost[from][from];
+    }
+
+    size_t column[N];
+    int best = solveAssignment(cost, column);
+
+    // ties keep the current seats, so sweeps over games come to a fixed point
+    if (best >= current) {
+        for (size_t seat = 0; seat < N; seat++) {
+            out_column[seat] = seat;
+        }
+        return 0;
+    }
+
+    std::copy(column, column + N, out_column);
+    return 2 * static_cast<int64_t>(best - current);
+}
+
+void SeatScoreEngine::reseatGameRows(size_t game_idx, const size_t (&column)[Configuration::MaxSeats])
+{
+    const auto& game = _schedule.games()[game_idx];
+    for (size_t seat = 0; seat < _num_seats; seat++) {
+        int* row = &_seats[game.getPlayerAtSeat(static_cast<seat_t>(seat)) * _num_seats];
+        row[seat]--;
+        row[column[seat]]++;
+    }
+}
+
+void SeatScoreEngine::commitGameSeating(size_t game_idx, const size_t (&column)[Configuration::MaxSeats],
+    int64_t sum_squares_delta)
+{
+    _sum_squares += sum_squares_delta;
+
+    // the player at a seat goes to its column, follow cycles of the permutation with switches
+    size_t targets[Configuration::MaxSeats];
+    std::copy(column, column + _num_seats, targets);
+    for (size_t seat = 0; seat < _num_seats; seat++) {
+        while (targets[seat] != seat) {
+            size_t target = targets[seat];
+            _schedule.switchSeats(game_idx, seat, target);
+            targets[seat] = targets[target];
+            targets[target] = target;
+        }
+    }
+}
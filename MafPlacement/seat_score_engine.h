@@ -0,0 +1,101 @@
+#pragma once
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "move_generator.h"
+#include "schedule.h"
+
+//
+// class SeatScoreEngine - keeps a live player x seat table of a schedule
+// and evaluates the seat score (see calcSeatScore) incrementally.
+// A seat switch changes only four cells of the table,
+// so its delta is evaluated in O(1).
+// All seat switches must go through the engine to keep the table in sync.
+//
+class SeatScoreEngine
+{
+public:
+    SeatScoreEngine(Schedule& schedule);
+    ~SeatScoreEngine() = default;
+
+public:
+    // rebuilds player x seat table from the schedule
+    void reset();
+
+    // current score, equal to calcSeatScore() of the schedule
+    double score() const;
+
+    // number of games where the player takes given seat
+    int seats(player_t player, seat_t seat) const
+    {
+        return _seats[player * _num_seats + seat];
+    }
+
+public:
+    // returns exact change of the score if seats are switched,
+    // the schedule is not modified
+    double calcSwitchSeatsDelta(size_t game_idx, size_t seat_one, size_t seat_two) const;
+
+    // commits seat switch to the schedule and the table
+    void switchSeats(size_t game_idx, size_t seat_one, size_t seat_two);
+
+    // rolls back the last committed seat switch
+    void rollback();
+
+    // returns exact change of the score if a move of players between games is applied,
+    // players take the seats of the players they replace. Complexity: O(substitutions)
+    double calcMoveDelta(const Move& move) const;
+
+    // updates the table for a move of players, the schedule is not modified:
+    // it must be called before the move is applied (see PlayerScoreEngine::applyMove)
+    void trackMove(const Move& move);
+
+public:
+    // seating of the game with the least score while the other games keep their seats (see solveAssignment).
+    // out_column: the new seat of the player at every seat, the first numSeats() entries are used.
+    // Returns the change of the sum of squares, zero keeps the current seating.
+    // Reads only the rows of the players of the game
+    int64_t solveGameSeating(size_t game_idx, size_t (&out_column)[Configuration::MaxSeats]) const;
+
+    // moves players of the game to the seats of the column in the table only.
+    // Touches only the rows of the players of the game, so games with disjoint players
+    // (games of a round) are reseated concurrently without locks.
+    // The schedule and the sums are updated later by commitGameSeating()
+    void reseatGameRows(size_t game_idx, const size_t (&column)[Configuration::MaxSeats]);
+
+    // applies the seating to the schedule and adds its change of the sum of squares,
+    // the rows must be reseated already
+    void commitGameSeating(size_t game_idx, const size_t (&column)[Configuration::MaxSeats], int64_t sum_squares_delta);
+
+private:
+    // updates the table as if players at given seats are switched
+    void applySwitchSeats(size_t game_idx, size_t seat_one, size_t seat_two);
+
+    // collects merged changes of cells made by the move into _cell_changes
+    void collectCellChanges(const Move& move) const;
+
+    // solveGameSeating() with the number of seats known at compile time
+    template <size_t N>
+    int64_t solveGameSeatingOf(size_t game_idx, size_t (&out_column)[Configuration::MaxSeats]) const;
+
+private:
+    Schedule& _schedule;
+    double _target;
+    size_t _num_seats;
+
+    // player x seat table: num_players * num_seats
+    std::vector<int> _seats;
+
+    // sums over the table
+    int64_t _sum_seats;
+    int64_t _sum_squares;
+
+    // last committed switch
+    size_t _last_game;
+    size_t _last_seat_one;
+    size_t _last_seat_two;
+
+    // scratch buffer of move evaluation: (player * num_seats + seat, change)
+    mutable std::vector<std::pair<size_t, int>> _cell_changes;
+};
@@ -1,158 +1,393 @@
 #include "solve.h"
 
+#include <algorithm>
+#include <thread>
+
+#include "annealing_optimizer.h"
+#include "checkpoint_writer.h"
+#include "exact_solver.h"
+#include "lower_bound.h"
 #include "metrics.h"
+#include "player_score_engine.h"
 #include "random_optimizer.h"
+#include "schedule_builder.h"
+#include "score.h"
 #include "seat_optimizer.h"
+#include "seat_score_engine.h"
+#include "stage_runner.h"
+#include "stop_condition.h"
+#include "tabu_optimizer.h"
+#include "telemetry.h"
+#include "tempering_optimizer.h"
 
 // --------------------------------------------------------------------------
 // solve and optimization methods
 // --------------------------------------------------------------------------
 
-double calcPlayerScore(const Schedule& schedule, Metrics& metrics)
+// number of replicas of parallel tempering, does not depend on hardware to keep runs reproducible
+const size_t NUM_REPLICAS = 16;
+
+// tempering runs its replicas on all threads, so its stages go one by one
+size_t calcStageThreads(const SolveParams& params)
+{
+    return (params.method == Method::Tempering) ? 1 : params.num_threads;
+}
+
+// threads of a greedy seat stage: stages of a batch share the threads,
+// a single stage solves games of a round on all of them
+size_t calcSeatThreads(const SolveParams& params)
+{
+    size_t num_threads = params.num_threads ? params.num_threads : std::thread::hardware_concurrency();
+    size_t num_stages = std::max<size_t>(1, std::min(params.num_stages, num_threads));
+    return std::max<size_t>(1, num_threads / num_stages);
+}
+
+// telemetry of a stage, nullptr if the solve has no trace
+std::unique_ptr<StageTelemetry> createTelemetry(const SolveParams& params, const char* phase, const char* optimizer,
+    size_t stage)
+{
+    if (!params.telemetry) {
+        return nullptr;
+    }
+    return std::make_unique<StageTelemetry>(*params.telemetry, phase, optimizer, stage);
+}
+
+// runs a single stage of player optimization, only annealing and greedy stages use the checkpoint slot.
+// Joint stages optimize seats too
+double optimizePlayers(Schedule& schedule, const SolveParams& params, size_t stage, uint64_t seed,
+    const StopCondition& stop, CheckpointSlot* checkpoint, size_t* out_good_iterations, size_t* out_total_iterations)
+{
+    size_t num_iterations = params.num_iterations;
+    Method method = params.method;
+    if (method == Method::Tempering) {
+        auto telemetry = createTelemetry(params, "players", "tempering", stage);
+        TemperingOptimizer optimizer(schedule, num_iterations, TemperingOptimizer::Target::Players,
+            params.moves, NUM_REPLICAS, params.num_threads, seed, stop, telemetry.get());
+        double score = optimizer.optimize();
+        *out_good_iterations = optimizer.goodIterations();
+        *out_total_iterations = optimizer.totalIterations();
+        return score;
+    }
+
+    if (method == Method::Tabu) {
+        auto telemetry = createTelemetry(params, "players", "tabu", stage);
+        TabuOptimizer optimizer(schedule, num_iterations, seed, stop, telemetry.get());
+        double score = optimizer.optimize();
+        *out_good_iterations = optimizer.goodIterations();
+        *out_total_iterations = optimizer.totalIterations();
+        return score;
+    }
+
+    // players and seats are annealed together, the score is the joint objective
+    if (method == Method::Joint) {
+        auto telemetry = createTelemetry(params, "joint", "annealing", stage);
+        AnnealingOptimizer optimizer(schedule, num_iterations, AnnealingOptimizer::Target::Joint,
+            CoolingParams::reheating(), params.moves, params.seat_weight, seed, stop, checkpoint, telemetry.get());
+        double score = optimizer.optimize();
+        *out_good_iterations = optimizer.goodIterations();
+        *out_total_iterations = optimizer.totalIterations();
+        return score;
+    }
+
+    // exact search starts from the best annealed schedule
+    if (method == Method::Annealing || method == Method::Exact) {
+        auto telemetry = createTelemetry(params, "players", "annealing", stage);
+        AnnealingOptimizer optimizer(schedule, num_iterations, AnnealingOptimizer::Target::Players,
+            CoolingParams::reheating(), params.moves, params.seat_weight, seed, stop, checkpoint, telemetry.get());
+        double score = optimizer.optimize();
+        *out_good_iterations = optimizer.goodIterations();
+        *out_total_iterations = optimizer.totalIterations();
+        return score;
+    }
+
+    auto telemetry = createTelemetry(params, "players", "greedy", stage);
+    RandomOptimizer optimizer(schedule, num_iterations, params.moves, seed, stop, checkpoint, telemetry.get());
+    double score = optimizer.optimize();
+    *out_good_iterations = optimizer.goodIterations();
+    *out_total_iterations = optimizer.totalIterations();
+    return score;
+}
+
+// runs a single stage of seat optimization, only annealing stages use the checkpoint slot
+double optimizeSeats(Schedule& schedule, const SolveParams& params, size_t stage, uint64_t seed,
+    const StopCondition& stop, CheckpointSlot* checkpoint)
 {
-    const auto& conf = schedule.config();
+    size_t num_iterations = params.num_iterations;
+    Method method = params.method;
+    if (method == Method::Tempering) {
+        auto telemetry = createTelemetry(params, "seats", "tempering", stage);
+        TemperingOptimizer optimizer(schedule, num_iterations, TemperingOptimizer::Target::Seats,
+            params.moves, NUM_REPLICAS, params.num_threads, seed, stop, telemetry.get());
+        return optimizer.optimize();
+    }
+
+    if (method == Method::Annealing || method == Method::Exact) {
+        auto telemetry = createTelemetry(params, "seats", "annealing", stage);
+        AnnealingOptimizer optimizer(schedule, num_iterations, AnnealingOptimizer::Target::Seats,
+            CoolingParams::geometric(), params.moves, params.seat_weight, seed, stop, checkpoint, telemetry.get());
+        return optimizer.optimize();
+    }
 
-    double sd_penalty = 0.0;
-    double add_penalty = 0.0;
-    double target = 9.0 * conf.numAttempts() / (conf.numPlayers() - 1);
-    for (int player = 0; player < conf.numPlayers(); player++)
-    {
-        auto opponents = metrics.calcPlayerOpponentsHistogram(player);
+    auto telemetry = createTelemetry(params, "seats", "greedy", stage);
+    SeatOptimizer optimizer(schedule, num_iterations, calcSeatThreads(params), seed, stop, telemetry.get());
+    return optimizer.optimize();
+}
 
-        double sd = Metrics::calcSquareDeviation(opponents, player, target);
-        sd_penalty += sd;
+// proves the optimum of players or narrows the gap to it until the time limit
+std::unique_ptr<Schedule> searchExact(const Schedule& incumbent, const SolveParams& params, const StopCondition& stop)
+{
+    ExactSolver solver(incumbent.config(), params.num_threads, params.time_limit, stop);
 
-        // int k[11] = { 100, 50, 0, 0, 0, 0, 20, 100, 200, 400, 800 };
-        // int k[11] = { 100, 50, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
-        // int k[11] = { 500, 100, 10, 0, 10, 50, 150, 200, 400, 800, 1000 };
+    printf("\n *** Exact search\n");
+    printf("Time limit: %.0f s\n", params.time_limit);
+    auto schedule = solver.solve(incumbent);
+    printf("Tasks: %zu. Nodes: %zu\n", solver.numTasks(), solver.numNodes());
 
-        int k[4] = { 300, 0, 0, 0 };
-        add_penalty += metrics.aggregate(opponents, player, [&k](int value) { return k[value]; });
+    if (solver.isOptimal()) {
+        printf("Optimal score: %8.4f\n", solver.score());
+    }
+    else {
+        printf("Best score: %8.4f. Lower bound: %8.4f. Gap: %8.4f\n",
+            solver.score(), solver.lowerBound(), solver.score() - solver.lowerBound());
     }
 
-    return sd_penalty + add_penalty;
+    return schedule;
 }
 
-double calcSeatScore(const Schedule& schedule, Metrics& metrics)
+// least score of the objective optimized by player stages, joint stages add weighted seats
+double calcPlayerPhaseBound(const Configuration& conf, const SolveParams& params)
 {
-    const auto& conf = schedule.config();
+    double lower_bound = calcPlayerLowerBound(conf);
+    if (params.method == Method::Joint) {
+        lower_bound += params.seat_weight * calcSeatLowerBound(conf);
+    }
+    return lower_bound;
+}
 
-    double target = conf.numAttempts() / (double)Configuration::NumSeats;
-    double sd_penalty = 0.0;
-    for (int player = 0; player < conf.numPlayers(); player++)
-    {
-        auto seats = metrics.calcPlayerSeatsHistogram(player);
+// score of the objective optimized by player stages, see calcPlayerPhaseBound
+double calcPlayerPhaseScore(Schedule& schedule, const SolveParams& params)
+{
+    double score = PlayerScoreEngine(schedule).score();
+    if (params.method == Method::Joint) {
+        score += params.seat_weight * SeatScoreEngine(schedule).score();
+    }
+    return score;
+}
 
-        double sd = Metrics::calcSquareDeviation(seats, -1, target);
-        sd_penalty += sd;
+// prints the best score against the lower bound, no stage goes on after reaching it
+void printLowerBound(double best_score, double lower_bound, const StopCondition& stop)
+{
+    printf("Lower bound: %8.4f. Gap: %8.4f\n", lower_bound, std::max(0.0, best_score - lower_bound));
+    if (stop.isBoundReached()) {
+        printf("Lower bound reached\n");
     }
+}
 
-    return sd_penalty;
+// prints limits of the solve
+void printSolveParams(const SolveParams& params, size_t num_threads)
+{
+    printf("Num stages: %zu\n", params.num_stages);
+    printf("Num iterations on every stage: %zu\n", params.num_iterations);
+    printf("Num threads: %zu\n", num_threads);
+    printf("Seed: %llu\n", static_cast<unsigned long long>(params.seed));
+    if (params.time_budget > 0) {
+        printf("Time budget: %.1f s\n", params.time_budget);
+    }
+    if (params.plateau_window > 0) {
+        printf("Plateau window: %zu\n", params.plateau_window);
+    }
 }
 
-std::unique_ptr<Schedule> solvePlayers(const Configuration& conf,
-    size_t num_stages,
-    size_t num_iterations)
+std::unique_ptr<Schedule> solvePlayers(const Configuration& conf, const SolveParams& params,
+    CheckpointWriter* checkpoint)
 {
-    // calculate only ONE single initial schedule - just to reduce computations
-    // assign this variable to ONE to get as many trivial initial schedules as possible
-    player_t player_step = static_cast<player_t>(conf.numPlayers());
+    StageRunner runner(calcStageThreads(params), params.seed);
+    StopCondition stop(params.time_budget, params.plateau_window);
+    double lower_bound = calcPlayerPhaseBound(conf, params);
+    stop.setLowerBound(lower_bound);
 
     printf("\n *** Player optimization\n");
-    printf("player_step: %d\n", player_step);
-    printf("Num stages: %zu\n", num_stages);
-    printf("Num iterations on every stage: %zu\n", num_iterations);
-
-    double best_score = FLT_MAX;
-    double worst_score = FLT_MIN;
-    std::unique_ptr<Schedule> best_schedule;
-
-    for (player_t player_shift = 0; player_shift < conf.numPlayers(); player_shift += player_step) {
-        printf("\n* Player shift: %d\n", player_shift);
-        for (size_t stage = 0; stage < num_stages; ++stage) {
-            // create initial schedule
+    printSolveParams(params, runner.numThreads());
+
+    // a loaded checkpoint continues its batch
+    size_t first_stage = 0;
+    if (checkpoint) {
+        first_stage = checkpoint->beginPhase(Checkpoint::Phase::Players, conf, nullptr, &runner);
+        if (first_stage > 0) {
+            printf("Resumed at stage: %zu\n", first_stage);
+        }
+    }
+
+    // stages run concurrently, every stage builds its own initial schedule.
+    // With a time budget batches of stages go on until the deadline
+    std::vector<ScheduleBuilder::Construction> constructions(params.num_stages);
+    std::vector<double> initial_scores(params.num_stages);
+    do {
+        if (checkpoint) {
+            checkpoint->beginBatch(params.num_stages, runner);
+        }
+
+        runner.run(params.num_stages, [&](size_t stage, uint64_t seed, StageRunner::Result* out_result) {
+            // greedy construction breaks ties with the stage seed, so stages start from different schedules
             std::unique_ptr<Schedule> schedule;
-            if (player_shift == 0) {
-                printf("\n*** Custom schedule\n");
-                std::vector<std::vector<player_t>> custom_seats = {
-                    { 1,  2,  3,  4,  5, 11, 12, 13, 14, 15 },
-                    { 6,  7,  8,  9, 10, 16, 17, 18, 19, 20 },
-                    { 1,  3,  5,  7,  9, 11, 13, 15, 17, 19 },
-                    { 2,  4,  6,  8, 10, 12, 14, 16, 18, 20 },
-                    //{ 2,  5,  9,  3,  7,  13, 15, 12, 18, 19 },
-                    //{ 1,  4,  8,  6, 10,  11, 14, 16, 17, 20 }
-                    { 11, 12, 13, 14, 15, 16, 17, 18, 19, 20 },
-                    { 1,  2,  3,  4,  5,  6, 7, 8, 9, 10 }
-                };
-                schedule = Schedule::createCustomSchedule(conf, custom_seats);
+            if (params.start) {
+                schedule = std::make_unique<Schedule>(*params.start);
             }
             else {
-                schedule = Schedule::createInitialSchedule(conf, player_shift);
+                Random random(Random::deriveSeed(seed, 0));
+                ScheduleBuilder builder(conf);
+                schedule = builder.build(random, &constructions[stage]);
             }
+            initial_scores[stage] = calcPlayerPhaseScore(*schedule, params);
 
             // print initial schedule
             // outputInitial(*schedule);
 
-            Metrics metrics(*schedule);
-            RandomOptimizer optimizer(*schedule, num_iterations,
-                [&](const Schedule& s) { return calcPlayerScore(s, metrics); });
-            double score = optimizer.optimize();
-            
-            size_t good_iterations = optimizer.goodIterations();
-            size_t total_iterations = optimizer.totalIterations();
-            printf("Stage: %3zu. Score: %10.2f. Iterations: %10zu / %10zu\n", 
-                stage, score, 
-                good_iterations, total_iterations);
-
-            if (score > worst_score) {
-                worst_score = score;
+            // a stage finished before the restart keeps its result
+            CheckpointSlot* slot = checkpoint ? checkpoint->slot(stage) : nullptr;
+            if (slot && slot->isFinished()) {
+                const auto& state = slot->state();
+                schedule->assignSeats(state.seats);
+                *out_result = { state.best_score, static_cast<size_t>(state.good_iterations),
+                    static_cast<size_t>(state.total_iterations), StageRunner::Status::Finished };
+                return schedule;
+            }
+
+            // a stage after the interrupt only scores its schedule
+            bool started = !StopCondition::isInterrupted();
+            out_result->score = optimizePlayers(*schedule, params, first_stage + stage, Random::deriveSeed(seed, 1), stop, slot,
+                &out_result->good_iterations, &out_result->total_iterations);
+            if (!started) {
+                out_result->status = StageRunner::Status::Interrupted;
+            }
+            else if (stop.isBoundReached() && !stop.isAtLowerBound(out_result->score)) {
+                out_result->status = StageRunner::Status::AtBound;
             }
-            if (score < best_score) {
-                best_score = score;
-                best_schedule = std::move(schedule);
+
+            // an interrupted stage continues after the restart
+            if (slot && !StopCondition::isInterrupted()) {
+                slot->finish(*schedule, *out_result);
+            }
+            return schedule;
+        });
+
+        // report stages in order
+        const auto& results = runner.results();
+        for (size_t stage = 0; stage < results.size(); ++stage) {
+            const char* construction = params.start ? "file" : ScheduleBuilder::getConstructionName(constructions[stage]);
+            if (results[stage].status != StageRunner::Status::Finished) {
+                printf("Stage: %3zu. Initial: %10.2f (%s). Stopped: %s\n", first_stage + stage, initial_scores[stage],
+                    construction, StageRunner::getStatusName(results[stage].status));
+                continue;
             }
+            printf("Stage: %3zu. Initial: %10.2f (%s). Score: %10.2f. Iterations: %10zu / %10zu\n",
+                first_stage + stage, initial_scores[stage], construction,
+                results[stage].score, results[stage].good_iterations, results[stage].total_iterations);
         }
+        first_stage += results.size();
+    } while (params.time_budget > 0 && !stop.isExpired());
+
+    if (checkpoint) {
+        checkpoint->write();
+    }
+
+    if (StopCondition::isInterrupted()) {
+        printf("Interrupted\n");
+    }
+
+    printf("Best score: %8.4f\n", runner.bestScore());
+    if (runner.hasWorstScore()) {
+        printf("Worst score: %8.4f\n", runner.worstScore());
     }
+    printLowerBound(runner.bestScore(), lower_bound, stop);
 
-    printf("Best score: %8.4f\n", best_score);
-    printf("Worst score: %8.4f\n", worst_score);
+    // return the best schedule, there is nothing to prove at the lower bound
+    auto best_schedule = runner.releaseBestSchedule();
+    if (params.method != Method::Exact || StopCondition::isInterrupted() || stop.isBoundReached()) {
+        return best_schedule;
+    }
 
-    // return the best schedule
-    return std::move(best_schedule);
+    return searchExact(*best_schedule, params, stop);
 }
 
-std::unique_ptr<Schedule> solveSeats(
-    const Schedule& initial_schedule,
-    size_t num_stages,
-    size_t num_iterations)
+std::unique_ptr<Schedule> solveSeats(const Schedule& initial_schedule, const SolveParams& params,
+    CheckpointWriter* checkpoint)
 {
+    StageRunner runner(calcStageThreads(params), params.seed);
+    StopCondition stop(params.time_budget, params.plateau_window);
+    double lower_bound = calcSeatLowerBound(initial_schedule.config());
+    stop.setLowerBound(lower_bound);
+
     printf("\n *** Seat optimization\n");
-    printf("Num stages: %zu\n", num_stages);
-    printf("Num iterations on every stage: %zu\n", num_iterations);
-
-    double best_score = FLT_MAX;
-    double worst_score = FLT_MIN;
-    std::unique_ptr<Schedule> best_schedule;
-
-    for (size_t stage = 0; stage < num_stages; stage++) {
-        Schedule schedule = initial_schedule;
-        Metrics metrics(schedule);
-        SeatOptimizer optimizer(schedule, num_iterations,
-            [&](const Schedule& s) { return calcSeatScore(s, metrics); });
-        double score = optimizer.optimize();
-        printf("Stage: %3zu. Score: %10.2f\n", stage, score);
+    printSolveParams(params, runner.numThreads());
+
+    size_t first_stage = 0;
+    if (checkpoint) {
+        first_stage = checkpoint->beginPhase(Checkpoint::Phase::Seats, initial_schedule.config(),
+            &initial_schedule, &runner);
+        if (first_stage > 0) {
+            printf("Resumed at stage: %zu\n", first_stage);
+        }
+    }
 
-        if (score > worst_score) {
-            worst_score = score;
+    // stages run concurrently, every stage has its own copy of the schedule
+    do {
+        if (checkpoint) {
+            checkpoint->beginBatch(params.num_stages, runner);
         }
-        if (score < best_score) {
-            best_score = score;
-            best_schedule = std::make_unique<Schedule>(schedule);
+
+        runner.run(params.num_stages, [&](size_t stage, uint64_t seed, StageRunner::Result* out_result) {
+            auto schedule = std::make_unique<Schedule>(initial_schedule);
+            out_result->good_iterations = 0;
+            out_result->total_iterations = params.num_iterations;
+
+            // a stage finished before the restart keeps its result
+            CheckpointSlot* slot = checkpoint ? checkpoint->slot(stage) : nullptr;
+            if (slot && slot->isFinished()) {
+                const auto& state = slot->state();
+                schedule->assignSeats(state.seats);
+                *out_result = { state.best_score, static_cast<size_t>(state.good_iterations),
+                    static_cast<size_t>(state.total_iterations), StageRunner::Status::Finished };
+                return schedule;
+            }
+
+            bool started = !StopCondition::isInterrupted();
+            out_result->score = optimizeSeats(*schedule, params, first_stage + stage, seed, stop, slot);
+            if (!started) {
+                out_result->status = StageRunner::Status::Interrupted;
+            }
+            else if (stop.isBoundReached() && !stop.isAtLowerBound(out_result->score)) {
+                out_result->status = StageRunner::Status::AtBound;
+            }
+            if (slot && !StopCondition::isInterrupted()) {
+                slot->finish(*schedule, *out_result);
+            }
+            return schedule;
+        });
+
+        const auto& results = runner.results();
+        for (size_t stage = 0; stage < results.size(); stage++) {
+            if (results[stage].status != StageRunner::Status::Finished) {
+                printf("Stage: %3zu. Stopped: %s\n", first_stage + stage, StageRunner::getStatusName(results[stage].status));
+                continue;
+            }
+            printf("Stage: %3zu. Score: %10.2f\n", first_stage + stage, results[stage].score);
         }
+        first_stage += results.size();
+    } while (params.time_budget > 0 && !stop.isExpired());
+
+    if (checkpoint) {
+        checkpoint->write();
     }
 
-    printf("Best score: %8.4f\n", best_score);
-    printf("Worst score: %8.4f\n", worst_score);
-    return std::move(best_schedule);
-}
+    if (StopCondition::isInterrupted()) {
+        printf("Interrupted\n");
+    }
 
+    printf("Best score: %8.4f\n", runner.bestScore());
+    if (runner.hasWorstScore()) {
+        printf("Worst score: %8.4f\n", runner.worstScore());
+    }
+    printLowerBound(runner.bestScore(), lower_bound, stop);
+    return runner.releaseBestSchedule();
+}
@@ -3,17 +3,73 @@
 #include <memory>
 
 #include "configuration.h"
+#include "move_generator.h"
 #include "schedule.h"
 
+class CheckpointWriter;
+class TelemetryWriter;
+
+// optimization method used on every stage
+enum class Method
+{
+    Greedy,     // RandomOptimizer/SeatOptimizer: accept only improving moves
+    Annealing,  // AnnealingOptimizer: simulated annealing
+    Tempering,  // TemperingOptimizer: parallel tempering, replicas use all threads
+    Tabu,       // TabuOptimizer: tabu search on players, greedy SeatOptimizer on seats
+    Exact,      // ExactSolver: branch and bound from the best annealed schedule, annealing on seats
+    Joint,      // AnnealingOptimizer: players and seats at once with JointMoves, no separate seat optimization
+};
+
+// parameters of player or seat optimization
+struct SolveParams
+{
+    // number of independent optimizations, the best one wins.
+    // With a time budget stages are run in batches of this size until the deadline
+    size_t num_stages;
+
+    // number of iterations on every stage
+    size_t num_iterations;
+
+    Method method;
+
+    // number of threads to run stages (or replicas for tempering), zero means all hardware threads
+    size_t num_threads;
+
+    // seed of the run, every stage derives its own seed from it
+    uint64_t seed;
+
+    // weights of player moves, tabu search uses only swaps
+    MoveWeights moves;
+
+    // joint method: weight of the seat score in the objective
+    double seat_weight;
+
+    // time limit of the exact search in seconds, zero means no limit
+    double time_limit;
+
+    // wall-clock budget of the solve in seconds, zero means the fixed number of stages
+    double time_budget;
+
+    // a stage stops after this number of probes without a new best score, zero means never
+    size_t plateau_window;
+
+    // players: every stage starts from this schedule instead of a constructed one, may be nullptr
+    const Schedule* start;
+
+    // trace of optimizer telemetry shared by all stages, may be nullptr
+    TelemetryWriter* telemetry;
+};
+
+// checkpoint: records the progress or continues a loaded checkpoint, may be nullptr
 std::unique_ptr<Schedule> solvePlayers(
     const Configuration& conf,
-    size_t num_stages,
-    size_t num_iterations);
+    const SolveParams& params,
+    CheckpointWriter* checkpoint);
 
 std::unique_ptr<Schedule> solveSeats(
     const Schedule& schedule,
-    size_t num_stages,
-    size_t num_iterations);
+    const SolveParams& params,
+    CheckpointWriter* checkpoint);
 
 
 
@@ -0,0 +1,58 @@
+#pragma once
+#include <cassert>
+#include <cstddef>
+
+//
+// class Span - non-owning view of consecutive elements (like std::span of C++20).
+// Valid while the owner of the elements is alive and not resized.
+//
+template <typename T>
+class Span
+{
+public:
+    Span()
+        : _data(nullptr)
+        , _size(0)
+    {}
+
+    Span(T* data, size_t size)
+        : _data(data)
+        , _size(size)
+    {}
+
+public:
+    T* begin() const
+    {
+        return _data;
+    }
+
+    T* end() const
+    {
+        return _data + _size;
+    }
+
+    T* data() const
+    {
+        return _data;
+    }
+
+    size_t size() const
+    {
+        return _size;
+    }
+
+    bool empty() const
+    {
+        return _size == 0;
+    }
+
+    T& operator[](size_t idx) const
+    {
+        assert(idx < _size);
+        return _data[idx];
+    }
+
+private:
+    T* _data;
+    size_t _size;
+};
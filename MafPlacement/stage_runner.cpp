@@ -0,0 +1,103 @@
+#include "stage_runner.h"
+
+#include "random.h"
+
+StageRunner::StageRunner(size_t num_threads, uint64_t seed)
+    : _pool(num_threads)
+    , _seed(seed)
+    , _stage_offset(0)
+{
+    _worker_schedules.resize(_pool.numThreads());
+    _worker_scores.resize(_pool.numThreads(), FLT_MAX);
+    _worker_orders.resize(_pool.numThreads(), 0);
+}
+
+void StageRunner::run(size_t num_stages, StageFn fn)
+{
+    _results.assign(num_stages, Result{ 0.0, 0, 0, Status::Finished });
+
+    _pool.run(num_stages, [&](size_t stage, size_t worker) {
+        // every stage has its own random sequence regardless of the worker
+        size_t order = _stage_offset + stage;
+        uint64_t seed = Random::deriveSeed(_seed, order);
+
+        Result result = { 0.0, 0, 0, Status::Finished };
+        auto schedule = fn(stage, seed, &result);
+        _results[stage] = result;
+
+        // do not keep schedules which can not be the best
+        bool is_best = (result.status == Status::Finished) ? _tracker.update(result.score)
+            : _tracker.updateBest(result.score);
+        if (!is_best) {
+            return;
+        }
+
+        // the earliest stage wins among equal scores, as in sequential run
+        double worker_score = _worker_scores[worker];
+        if (result.score < worker_score ||
+            (result.score == worker_score && order < _worker_orders[worker])) {
+            _worker_schedules[worker] = std::move(schedule);
+            _worker_scores[worker] = result.score;
+            _worker_orders[worker] = order;
+        }
+    });
+
+    _stage_offset += num_stages;
+}
+
+const char* StageRunner::getStatusName(Status status)
+{
+    switch (status) {
+    case Status::Interrupted:
+        return "interrupted";
+    case Status::AtBound:
+        return "at bound";
+    default:
+        return "finished";
+    }
+}
+
+const Schedule* StageRunner::bestSchedule(size_t* out_order) const
+{
+    size_t best_worker = findBestWorker();
+    *out_order = _worker_orders[best_worker];
+    return _worker_schedules[best_worker].get();
+}
+
+std::unique_ptr<Schedule> StageRunner::releaseBestSchedule()
+{
+    return std::move(_worker_schedules[findBestWorker()]);
+}
+
+void StageRunner::restore(size_t stage_offset, std::unique_ptr<Schedule> best_schedule,
+    double best_score, double worst_score, size_t best_order)
+{
+    _stage_offset = stage_offset;
+    if (!best_schedule) {
+        return;
+    }
+
+    _tracker.update(best_score);
+    _tracker.update(worst_score);
+    _worker_schedules[0] = std::move(best_schedule);
+    _worker_scores[0] = best_score;
+    _worker_orders[0] = best_order;
+}
+
+size_t StageRunner::findBestWorker() const
+{
+    size_t best_worker = 0;
+    for (size_t worker = 1; worker < _worker_schedules.size(); worker++) {
+        if (!_worker_schedules[worker])
+            continue;
+
+        if (!_worker_schedules[best_worker] ||
+            _worker_scores[worker] < _worker_scores[best_worker] ||
+            (_worker_scores[worker] == _worker_scores[best_worker] &&
+                _worker_orders[worker] < _worker_orders[best_worker])) {
+            best_worker = worker;
+        }
+    }
+
+    return best_worker;
+}
@@ -0,0 +1,112 @@
+#pragma once
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "best_score_tracker.h"
+#include "schedule.h"
+#include "thread_pool.h"
+
+//
+// class StageRunner - runs independent optimization stages concurrently.
+// Every stage creates and optimizes its own schedule on a worker thread
+// with its own random seed derived from the run seed and the stage index;
+// the runner keeps the best schedule.
+// Results do not depend on the number of threads.
+//
+class StageRunner
+{
+public:
+    // a stopped stage has no result of its own: its score is the schedule it was left with,
+    // it may still be the best schedule but does not count as the worst one
+    enum class Status
+    {
+        Finished,
+        Interrupted,    // the run was interrupted before the stage started
+        AtBound,        // another stage reached the lower bound first (see StopCondition)
+    };
+
+    struct Result
+    {
+        double score;
+        size_t good_iterations;
+        size_t total_iterations;
+        Status status;
+    };
+
+    // stage function: stage index, stage seed -> optimized schedule of the stage and its result
+    typedef std::function<std::unique_ptr<Schedule>(size_t, uint64_t, Result*)> StageFn;
+
+public:
+    // zero number of threads means all hardware threads
+    StageRunner(size_t num_threads, uint64_t seed);
+    ~StageRunner() = default;
+
+public:
+    // runs stages [0, num_stages), the best schedule is kept across runs
+    void run(size_t num_stages, StageFn fn);
+
+    // results of the stages of the last run
+    const std::vector<Result>& results() const
+    {
+        return _results;
+    }
+
+    double bestScore() const
+    {
+        return _tracker.best();
+    }
+
+    double worstScore() const
+    {
+        return _tracker.worst();
+    }
+
+    // returns false if no stage has finished yet
+    bool hasWorstScore() const
+    {
+        return _tracker.hasWorst();
+    }
+
+    size_t numThreads() const
+    {
+        return _pool.numThreads();
+    }
+
+    // number of stages in all previous runs
+    size_t stageOffset() const
+    {
+        return _stage_offset;
+    }
+
+    // the best schedule of all runs and the order of its stage, nullptr if there is none
+    const Schedule* bestSchedule(size_t* out_order) const;
+
+    // returns the best schedule of all runs
+    std::unique_ptr<Schedule> releaseBestSchedule();
+
+    static const char* getStatusName(Status status);
+
+    // continues the runs of a previous process (see Checkpoint):
+    // the number of its stages, their best schedule and scores
+    void restore(size_t stage_offset, std::unique_ptr<Schedule> best_schedule,
+        double best_score, double worst_score, size_t best_order);
+
+private:
+    // worker which keeps the best schedule
+    size_t findBestWorker() const;
+
+private:
+    ThreadPool _pool;
+    BestScoreTracker _tracker;
+    std::vector<Result> _results;
+    uint64_t _seed;
+
+    // number of stages in all previous runs, orders stages with equal scores
+    size_t _stage_offset;
+
+    // best schedule of every worker, its score and order
+    std::vector<std::unique_ptr<Schedule>> _worker_schedules;
+    std::vector<double> _worker_scores;
+    std::vector<size_t> _worker_orders;
+};
@@ -0,0 +1,51 @@
+#include "stop_condition.h"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+
+std::atomic<bool> StopCondition::_interrupted(false);
+
+StopCondition::StopCondition(double time_budget, size_t plateau_window)
+    : _has_deadline(time_budget > 0.0)
+    , _plateau_window(plateau_window)
+    , _has_lower_bound(false)
+    , _lower_bound(0.0)
+    , _tolerance(0.0)
+    , _bound_reached(false)
+{
+    auto budget = std::chrono::duration<double>(std::max(time_budget, 0.0));
+    _deadline = std::chrono::steady_clock::now()
+        + std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget);
+}
+
+void StopCondition::installSignalHandlers()
+{
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+}
+
+void StopCondition::handleSignal(int signal)
+{
+    // only a lock-free flag may be touched in a signal handler
+    _interrupted.store(true, std::memory_order_relaxed);
+    std::signal(signal, SIG_DFL);
+}
+
+void StopCondition::setLowerBound(double lower_bound)
+{
+    // scores are summed incrementally by the engines, so they may drift slightly off the bound
+    const double RELATIVE_TOLERANCE = 1e-7;
+    _has_lower_bound = true;
+    _lower_bound = lower_bound;
+    _tolerance = RELATIVE_TOLERANCE * std::max(1.0, std::abs(lower_bound));
+}
+
+bool StopCondition::isExpired() const
+{
+    if (isInterrupted() || isBoundReached()) {
+        return true;
+    }
+
+    return _has_deadline && std::chrono::steady_clock::now() >= _deadline;
+}
@@ -0,0 +1,82 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+
+//
+// class StopCondition - tells optimizers to stop before their iteration count:
+// at the deadline of the time budget, on a plateau (no new best score
+// within a window of probes), when the run is interrupted by SIGINT / SIGTERM
+// or when an optimizer reports a score at the lower bound (see lower_bound.h),
+// since no stage can do better then.
+// A stopped optimizer finishes the current move and leaves its best schedule.
+// One condition is shared by all stages of a solve, it is thread safe.
+//
+class StopCondition
+{
+public:
+    // zero time budget means no deadline, zero window means no plateau detection
+    StopCondition(double time_budget, size_t plateau_window);
+    ~StopCondition() = default;
+
+public:
+    // installs handlers of SIGINT and SIGTERM which interrupt all optimizations,
+    // the second signal terminates the process as usual
+    static void installSignalHandlers();
+
+    static bool isInterrupted()
+    {
+        return _interrupted.load(std::memory_order_relaxed);
+    }
+
+    // sets the least score of the optimized objective, by default there is no bound
+    void setLowerBound(double lower_bound);
+
+    bool isAtLowerBound(double score) const
+    {
+        return _has_lower_bound && score <= _lower_bound + _tolerance;
+    }
+
+    // optimizers report every new best score, the one at the bound stops all of them
+    void reportScore(double score) const
+    {
+        if (isAtLowerBound(score)) {
+            _bound_reached.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    bool isBoundReached() const
+    {
+        return _bound_reached.load(std::memory_order_relaxed);
+    }
+
+    // returns true if the run is interrupted, the bound is reached or the deadline has passed
+    bool isExpired() const;
+
+    // returns true if there is no new best score for the plateau window
+    bool isPlateau(size_t probes_since_best) const
+    {
+        return _plateau_window != 0 && probes_since_best >= _plateau_window;
+    }
+
+    // checked on every probe, the clock is read once in a while
+    bool shouldStop(size_t iteration, size_t probes_since_best) const
+    {
+        const size_t CLOCK_INTERVAL = 1024;
+        return isPlateau(probes_since_best) || isInterrupted() || isBoundReached()
+            || (_has_deadline && iteration % CLOCK_INTERVAL == 0 && isExpired());
+    }
+
+private:
+    static void handleSignal(int signal);
+
+private:
+    static std::atomic<bool> _interrupted;
+
+    bool _has_deadline;
+    std::chrono::steady_clock::time_point _deadline;
+    size_t _plateau_window;
+    bool _has_lower_bound;
+    double _lower_bound;
+    double _tolerance;
+    mutable std::atomic<bool> _bound_reached;
+};
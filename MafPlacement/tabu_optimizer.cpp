@@ -0,0 +1,162 @@
+#include "tabu_optimizer.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <memory>
+
+#include "move_generator.h"
+#include "player_score_engine.h"
+
+namespace {
+
+// candidate switches evaluated on every step
+const size_t NUM_CANDIDATES = 512;
+
+// number of recently visited schedules remembered
+const size_t NUM_VISITED = 4096;
+
+} // namespace
+
+void TabuOptimizer::visit(uint64_t hash)
+{
+    if (!_visited.insert(hash).second) {
+        return;
+    }
+
+    _visited_order.push_back(hash);
+    if (_visited_order.size() > NUM_VISITED) {
+        _visited.erase(_visited_order.front());
+        _visited_order.pop_front();
+    }
+}
+
+double TabuOptimizer::optimize()
+{
+    const auto& conf = _schedule.config();
+    PlayerScoreEngine engine(_schedule);
+
+    _total_iterations = 0;
+    _good_iterations = 0;
+    _tabu_until.assign(conf.numPlayers() * conf.numGames(), 0);
+    _visited.clear();
+    _visited_order.clear();
+
+    // a player stays out of the game they left for a few rounds of moves
+    size_t tenure = 7 + conf.numPlayers() / 4;
+
+    double score = engine.score();
+    double best_score = score;
+    bool at_best = true;
+    _stop.reportScore(best_score);
+    std::unique_ptr<Schedule> best_schedule;
+    size_t best_iteration = 0;
+    bool stopped = false;
+    visit(_schedule.hash());
+
+    // valid pairs of games are precomputed, a candidate is sampled directly
+    SwapMoveGenerator generator(_schedule);
+    Move move;
+
+    // a candidate is a probe, the made switch of a step is the accepted one
+    TelemetryCounters counters = {};
+    auto sample = [&]() {
+        _telemetry->sample(_total_iterations, counters, score, best_score, engine.sdPenalty(), engine.addPenalty());
+    };
+
+    for (size_t step = 1; _total_iterations < _max_iterations && !stopped; step++) {
+        // the best allowed candidate of the step
+        double best_delta = DBL_MAX;
+        size_t best_game_one = 0;
+        size_t best_game_two = 0;
+        player_t best_player_one = InvalidPlayerId;
+        player_t best_player_two = InvalidPlayerId;
+        uint64_t best_hash = 0;
+
+        for (size_t c = 0; c < NUM_CANDIDATES && _total_iterations < _max_iterations; c++) {
+            if (_stop.shouldStop(_total_iterations, _total_iterations - best_iteration)) {
+                stopped = true;
+                break;
+            }
+            if (_telemetry && _telemetry->isDue(_total_iterations)) {
+                sample();
+            }
+            ProbeTimer timer(counters, _telemetry && StageTelemetry::isTimed(_total_iterations));
+            _total_iterations++;
+            counters.probes++;
+
+            if (!generator.generate(_random, &move)) {
+                counters.failed++;
+                continue;
+            }
+            timer.lap(ProbeTimer::Part::Move);
+
+            // a swap puts the player of the second game to the first one and vice versa
+            size_t game_one = move.substitutions[0].game;
+            size_t game_two = move.substitutions[1].game;
+            player_t player_one = move.substitutions[1].player;
+            player_t player_two = move.substitutions[0].player;
+
+            double delta = engine.calcSwitchPlayersDelta(player_one, game_one, player_two, game_two);
+            timer.lap(ProbeTimer::Part::Score);
+            if (delta >= best_delta) {
+                continue;
+            }
+
+            // aspiration: a new best score is allowed even if the move is tabu
+            uint64_t hash = _schedule.calcSwitchPlayersHash(player_one, game_one, player_two, game_two);
+            bool aspiration = score + delta < best_score;
+            bool tabu = isTabu(player_one, game_two, step) || isTabu(player_two, game_one, step) || isVisited(hash);
+            if (tabu && !aspiration) {
+                continue;
+            }
+
+            best_delta = delta;
+            best_game_one = game_one;
+            best_game_two = game_two;
+            best_player_one = player_one;
+            best_player_two = player_two;
+            best_hash = hash;
+        }
+
+        if (stopped || best_player_one == InvalidPlayerId) {
+            continue;
+        }
+
+        // the best schedule is copied only when we are about to leave it uphill
+        if (best_delta > 0 && at_best) {
+            if (best_schedule)
+                *best_schedule = _schedule;
+            else
+                best_schedule = std::make_unique<Schedule>(_schedule);
+            at_best = false;
+        }
+
+        engine.switchPlayers(best_player_one, best_game_one, best_player_two, best_game_two);
+        _good_iterations++;
+        counters.accepted++;
+
+        // players may not go back to the games they left
+        makeTabu(best_player_one, best_game_one, step + tenure);
+        makeTabu(best_player_two, best_game_two, step + tenure);
+        visit(best_hash);
+
+        score = engine.score();
+        if (score < best_score) {
+            best_score = score;
+            at_best = true;
+            best_iteration = _total_iterations;
+            _stop.reportScore(best_score);
+        }
+    }
+
+    if (_telemetry) {
+        sample();
+    }
+
+    // restore the best schedule
+    if (!at_best) {
+        _schedule = *best_schedule;
+    }
+
+    return best_score;
+}
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <unordered_set>
+#include <vector>
+
+#include "random.h"
+#include "schedule.h"
+#include "stop_condition.h"
+#include "telemetry.h"
+
+//
+// class TabuOptimizer - optimizes players' opponents with tabu search.
+// On every step it samples several switches of players between games
+// of the same round and makes the best allowed one, even if it is uphill.
+// A player may not return to the game they just left for a while,
+// and schedules visited recently (by Zobrist hash) are not entered again.
+// A tabu move is still allowed if it gives a new best score.
+// The best schedule found during the run is left in place,
+// also when the run is stopped early (see StopCondition).
+// With telemetry the counters of candidates and the score are sampled to the trace.
+//
+class TabuOptimizer
+{
+public:
+    TabuOptimizer(
+        Schedule& schedule,
+        size_t max_iterations,
+        uint64_t seed,
+        const StopCondition& stop,
+        StageTelemetry* telemetry)
+        : _schedule(schedule)
+        , _max_iterations(max_iterations)
+        , _random(seed)
+        , _stop(stop)
+        , _telemetry(telemetry)
+        , _total_iterations(0)
+        , _good_iterations(0)
+    {}
+
+public:
+    double optimize();
+
+    // number of evaluated candidate switches
+    size_t totalIterations() const
+    {
+        return _total_iterations;
+    }
+
+    // number of made switches
+    size_t goodIterations() const
+    {
+        return _good_iterations;
+    }
+
+private:
+    bool isTabu(player_t player, size_t game_idx, size_t step) const
+    {
+        return _tabu_until[player * _schedule.config().numGames() + game_idx] > step;
+    }
+
+    void makeTabu(player_t player, size_t game_idx, size_t until_step)
+    {
+        _tabu_until[player * _schedule.config().numGames() + game_idx] = until_step;
+    }
+
+    bool isVisited(uint64_t hash) const
+    {
+        return _visited.count(hash) != 0;
+    }
+
+    void visit(uint64_t hash);
+
+private:
+    Schedule& _schedule;
+    size_t _max_iterations;
+    Random _random;
+    const StopCondition& _stop;
+    StageTelemetry* _telemetry;
+
+    // step until which a player may not enter a game: num_players * num_games
+    std::vector<size_t> _tabu_until;
+
+    // hashes of recently visited schedules, oldest first
+    std::unordered_set<uint64_t> _visited;
+    std::deque<uint64_t> _visited_order;
+
+    size_t _total_iterations;
+    size_t _good_iterations;
+};
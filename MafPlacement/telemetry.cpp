@@ -0,0 +1,98 @@
+#include "telemetry.h"
+
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+
+#include "platform.h"
+
+const size_t StageTelemetry::MAX_SAMPLE_INTERVAL;
+const size_t StageTelemetry::TIMING_INTERVAL;
+
+void TelemetryCounters::add(const TelemetryCounters& other)
+{
+    probes += other.probes;
+    accepted += other.accepted;
+    failed += other.failed;
+    timed_probes += other.timed_probes;
+    move_seconds += other.move_seconds;
+    score_seconds += other.score_seconds;
+}
+
+TelemetryWriter::TelemetryWriter(const std::string& path)
+    : _file(nullptr)
+    , _csv(false)
+    , _start(std::chrono::steady_clock::now())
+{
+    size_t dot = path.find_last_of('.');
+    std::string extension = (dot == std::string::npos) ? "" : path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+    _csv = extension == "csv";
+
+    if (fopen_s(&_file, path.c_str(), "w") != 0 || !_file) {
+        static char msg[1024];
+        sprintf_s(msg, "Can not create telemetry file: %s", path.c_str());
+        throw std::runtime_error(msg);
+    }
+
+    if (_csv) {
+        write("phase,optimizer,stage,iteration,seconds,probes,accepted,rejected,failed,"
+            "score,best_score,sd_penalty,add_penalty,move_seconds,score_seconds");
+    }
+}
+
+TelemetryWriter::~TelemetryWriter()
+{
+    fclose(_file);
+}
+
+void TelemetryWriter::write(const char* line)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    fputs(line, _file);
+    fputc('\n', _file);
+    fflush(_file);
+}
+
+double TelemetryWriter::elapsed() const
+{
+    std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - _start;
+    return seconds.count();
+}
+
+void StageTelemetry::sample(size_t iteration, const TelemetryCounters& counters,
+    double score, double best_score, double sd_penalty, double add_penalty)
+{
+    // timed probes stand for all probes
+    double scale = counters.timed_probes ? static_cast<double>(counters.probes) / counters.timed_probes : 0.0;
+    double move_seconds = counters.move_seconds * scale;
+    double score_seconds = counters.score_seconds * scale;
+
+    char line[1024];
+    if (_writer.isCsv()) {
+        sprintf_s(line, "%s,%s,%zu,%zu,%.6f,%llu,%llu,%llu,%llu,%.4f,%.4f,%.4f,%.4f,%.6f,%.6f",
+            _phase, _optimizer, _stage, iteration, _writer.elapsed(),
+            static_cast<unsigned long long>(counters.probes),
+            static_cast<unsigned long long>(counters.accepted),
+            static_cast<unsigned long long>(counters.rejected()),
+            static_cast<unsigned long long>(counters.failed),
+            score, best_score, sd_penalty, add_penalty, move_seconds, score_seconds);
+    }
+    else {
+        sprintf_s(line, "{\"phase\": \"%s\", \"optimizer\": \"%s\", \"stage\": %zu, \"iteration\": %zu, "
+            "\"seconds\": %.6f, \"probes\": %llu, \"accepted\": %llu, \"rejected\": %llu, \"failed\": %llu, "
+            "\"score\": %.4f, \"best_score\": %.4f, \"sd_penalty\": %.4f, \"add_penalty\": %.4f, "
+            "\"move_seconds\": %.6f, \"score_seconds\": %.6f}",
+            _phase, _optimizer, _stage, iteration, _writer.elapsed(),
+            static_cast<unsigned long long>(counters.probes),
+            static_cast<unsigned long long>(counters.accepted),
+            static_cast<unsigned long long>(counters.rejected()),
+            static_cast<unsigned long long>(counters.failed),
+            score, best_score, sd_penalty, add_penalty, move_seconds, score_seconds);
+    }
+    _writer.write(line);
+
+    // the step doubles up to the maximal interval
+    _next_sample = iteration + std::max<size_t>(1, std::min(iteration, MAX_SAMPLE_INTERVAL));
+}
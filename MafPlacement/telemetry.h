@@ -0,0 +1,159 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+// --------------------------------------------------------------------------
+// telemetry of optimizers: counters of probes and samples of the score
+// streamed to a trace file while stages run.
+// A sample is a line of JSON (.jsonl and any other extension) or CSV (.csv).
+// --------------------------------------------------------------------------
+
+// counters of an optimization stage, kept by the optimizer on every probe
+struct TelemetryCounters
+{
+    // generated probes, every one is accepted, rejected or failed
+    uint64_t probes;
+    uint64_t accepted;
+
+    // no valid move was found, e.g. all tries of a swap search hit players of other games
+    uint64_t failed;
+
+    // time of every TIMING_INTERVAL-th probe split into moves (generate and apply) and scoring (delta)
+    uint64_t timed_probes;
+    double move_seconds;
+    double score_seconds;
+
+    uint64_t rejected() const
+    {
+        return probes - accepted - failed;
+    }
+
+    void add(const TelemetryCounters& other);
+};
+
+//
+// class TelemetryWriter - trace file of a run, shared by all stages.
+// Samples are written under a lock and flushed, so the trace can be followed while the run goes on.
+//
+class TelemetryWriter
+{
+public:
+    // truncates the file, throws std::runtime_error if it can not be created
+    explicit TelemetryWriter(const std::string& path);
+    ~TelemetryWriter();
+
+    TelemetryWriter(const TelemetryWriter&) = delete;
+    TelemetryWriter& operator=(const TelemetryWriter&) = delete;
+
+public:
+    void write(const char* line);
+
+    bool isCsv() const
+    {
+        return _csv;
+    }
+
+    // seconds since the trace is opened
+    double elapsed() const;
+
+private:
+    FILE* _file;
+    bool _csv;
+    std::mutex _mutex;
+    std::chrono::steady_clock::time_point _start;
+};
+
+//
+// class StageTelemetry - samples of one stage of an optimization.
+// Samples go on a low-overhead schedule: at iterations 0, 1, 2, 4, ...
+// while the step doubles, then every MAX_SAMPLE_INTERVAL iterations, and once at the end.
+// An optimizer checks isDue() on every probe, which is one comparison.
+//
+class StageTelemetry
+{
+public:
+    static const size_t MAX_SAMPLE_INTERVAL = 64 * 1024;
+    static const size_t TIMING_INTERVAL = 64;
+
+public:
+    // phase: "players", "seats" or "joint", optimizer: name of the method
+    StageTelemetry(TelemetryWriter& writer, const char* phase, const char* optimizer, size_t stage)
+        : _writer(writer)
+        , _phase(phase)
+        , _optimizer(optimizer)
+        , _stage(stage)
+        , _next_sample(0)
+    {}
+
+public:
+    bool isDue(size_t iteration) const
+    {
+        return iteration >= _next_sample;
+    }
+
+    // the probe is timed with ProbeTimer
+    static bool isTimed(size_t iteration)
+    {
+        return iteration % TIMING_INTERVAL == 0;
+    }
+
+    // writes a sample and schedules the next one, parts of the score are
+    // the square deviation from the target and additional pair penalties (see PlayerScoreEngine)
+    void sample(size_t iteration, const TelemetryCounters& counters,
+        double score, double best_score, double sd_penalty, double add_penalty);
+
+private:
+    TelemetryWriter& _writer;
+    const char* _phase;
+    const char* _optimizer;
+    size_t _stage;
+    size_t _next_sample;
+};
+
+//
+// class ProbeTimer - splits time of a probe into moves and scoring.
+// Reads the clock only when enabled, every lap adds the time since the previous one to a part.
+//
+class ProbeTimer
+{
+public:
+    enum class Part
+    {
+        Move,
+        Score,
+    };
+
+public:
+    ProbeTimer(TelemetryCounters& counters, bool enabled)
+        : _counters(counters)
+        , _enabled(enabled)
+    {
+        if (_enabled) {
+            _counters.timed_probes++;
+            _last = std::chrono::steady_clock::now();
+        }
+    }
+
+    void lap(Part part)
+    {
+        if (!_enabled) {
+            return;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::chrono::duration<double> seconds = now - _last;
+        if (part == Part::Move)
+            _counters.move_seconds += seconds.count();
+        else
+            _counters.score_seconds += seconds.count();
+        _last = now;
+    }
+
+private:
+    TelemetryCounters& _counters;
+    bool _enabled;
+    std::chrono::steady_clock::time_point _last;
+};
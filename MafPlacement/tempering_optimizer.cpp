@@ -0,0 +1,230 @@
+#include "tempering_optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "cooling_schedule.h"
+#include "thread_pool.h"
+
+namespace {
+
+// number of moves every replica makes between exchanges
+const size_t EXCHANGE_INTERVAL = 1000;
+
+// a copy of the schedule walking at a fixed temperature
+template <typename Moves>
+struct Replica
+{
+    Replica(const Schedule& initial, const MoveWeights& weights, uint64_t seed, bool timed)
+        : schedule(initial)
+        , random(seed)
+        , moves(schedule, random, weights)
+        , best_score(moves.score())
+        , at_best(true)
+        , total_iterations(0)
+        , good_iterations(0)
+        , counters()
+        , timed(timed)
+    {}
+
+    // makes given number of Metropolis moves at temperature
+    void walk(size_t num_iterations, double temperature)
+    {
+        for (size_t i = 0; i < num_iterations; i++) {
+            ProbeTimer timer(counters, timed && StageTelemetry::isTimed(total_iterations));
+            total_iterations++;
+            counters.probes++;
+            if (!moves.generate()) {
+                counters.failed++;
+                continue;
+            }
+            timer.lap(ProbeTimer::Part::Move);
+
+            double delta = moves.delta();
+            timer.lap(ProbeTimer::Part::Score);
+            bool uphill = delta > 0;
+            if (uphill && random.generateProbability() >= std::exp(-delta / temperature)) {
+                continue;
+            }
+
+            // the best schedule is copied only when we are about to leave it uphill
+            if (uphill && at_best) {
+                if (best_schedule)
+                    *best_schedule = schedule;
+                else
+                    best_schedule = std::make_unique<Schedule>(schedule);
+                at_best = false;
+            }
+
+            moves.apply();
+            timer.lap(ProbeTimer::Part::Move);
+            good_iterations++;
+            counters.accepted++;
+
+            double score = moves.score();
+            if (score < best_score) {
+                best_score = score;
+                at_best = true;
+            }
+        }
+    }
+
+    const Schedule& bestSchedule() const
+    {
+        return at_best ? schedule : *best_schedule;
+    }
+
+    Schedule schedule;
+    Random random;
+    Moves moves;
+
+    double best_score;
+    bool at_best;
+    std::unique_ptr<Schedule> best_schedule;
+
+    size_t total_iterations;
+    size_t good_iterations;
+
+    // probes are timed only with telemetry
+    TelemetryCounters counters;
+    bool timed;
+};
+
+} // namespace
+
+double TemperingOptimizer::optimize()
+{
+    if (_target == Target::Players && _weights.isSwapsOnly()) {
+        return temper<SwapMoves>();
+    }
+
+    if (_target == Target::Players) {
+        return temper<PlayerMoves>();
+    }
+
+    return temper<SeatMoves>();
+}
+
+template <typename Moves>
+double TemperingOptimizer::temper()
+{
+    assert(_num_replicas >= 2);
+
+    // replicas own their schedules, random generators and score engines
+    std::vector<std::unique_ptr<Replica<Moves>>> replicas;
+    for (size_t r = 0; r < _num_replicas; r++) {
+        replicas.push_back(std::make_unique<Replica<Moves>>(_schedule, _weights, Random::deriveSeed(_seed, r),
+            _telemetry != nullptr));
+    }
+    Random random(Random::deriveSeed(_seed, _num_replicas));
+
+    // estimate an average and the smallest uphill moves to scale temperatures
+    const size_t NUM_SAMPLES = 10 * 1000;
+    double uphill_sum = 0.0;
+    double uphill_min = 0.0;
+    size_t uphill_count = 0;
+    auto& moves = replicas[0]->moves;
+    for (size_t i = 0; i < NUM_SAMPLES; i++) {
+        if (moves.generate()) {
+            double delta = moves.delta();
+            if (delta > 0) {
+                uphill_sum += delta;
+                uphill_min = uphill_count ? std::min(uphill_min, delta) : delta;
+                uphill_count++;
+            }
+        }
+    }
+    double average_uphill = std::max(uphill_count ? uphill_sum / uphill_count : 1.0, 1e-9);
+    double smallest_uphill = std::max(uphill_count ? uphill_min : 1.0, 1e-9);
+
+    // geometric ladder of temperatures: the hottest replica crosses average uphill moves,
+    // the coldest one refines a constructed schedule at the scale of the smallest ones
+    auto params = CoolingParams::geometric();
+    double t_max = -average_uphill / std::log(params.initial_acceptance);
+    double t_min = -smallest_uphill / std::log(params.final_acceptance);
+    std::vector<double> temperatures(_num_replicas);
+    for (size_t level = 0; level < _num_replicas; level++) {
+        temperatures[level] = t_min * std::pow(t_max / t_min, level / (_num_replicas - 1.0));
+    }
+
+    // replica at every temperature level, the coldest level goes first
+    std::vector<size_t> replica_at(_num_replicas);
+    for (size_t level = 0; level < _num_replicas; level++) {
+        replica_at[level] = level;
+    }
+
+    size_t num_threads = _num_threads ? _num_threads : std::thread::hardware_concurrency();
+    ThreadPool pool(std::min(num_threads, _num_replicas));
+    _exchanges = 0;
+
+    // a plateau is counted in iterations of a replica without a new best score of all replicas
+    double best_score = replicas[0]->best_score;
+    size_t best_epoch = 0;
+    _stop.reportScore(best_score);
+
+    // counters of all replicas and the score of the coldest one
+    auto sample = [&](size_t iteration) {
+        TelemetryCounters counters = {};
+        for (const auto& replica : replicas) {
+            counters.add(replica->counters);
+        }
+        const auto& cold = replicas[replica_at[0]]->moves;
+        _telemetry->sample(iteration, counters, cold.score(), best_score, cold.sdPenalty(), cold.addPenalty());
+    };
+
+    size_t num_epochs = (_max_iterations + EXCHANGE_INTERVAL - 1) / EXCHANGE_INTERVAL;
+    size_t epoch = 0;
+    for (; epoch < num_epochs; epoch++) {
+        if (_stop.isExpired() || _stop.isPlateau((epoch - best_epoch) * EXCHANGE_INTERVAL)) {
+            break;
+        }
+
+        if (_telemetry && _telemetry->isDue(epoch * EXCHANGE_INTERVAL)) {
+            sample(epoch * EXCHANGE_INTERVAL);
+        }
+
+        size_t num_iterations = std::min(EXCHANGE_INTERVAL, _max_iterations - epoch * EXCHANGE_INTERVAL);
+        pool.run(_num_replicas, [&](size_t level, size_t) {
+            replicas[replica_at[level]]->walk(num_iterations, temperatures[level]);
+        });
+
+        // exchange neighbour levels, even and odd pairs in turn
+        for (size_t level = epoch % 2; level + 1 < _num_replicas; level += 2) {
+            double score_cold = replicas[replica_at[level]]->moves.score();
+            double score_hot = replicas[replica_at[level + 1]]->moves.score();
+            double exponent = (1.0 / temperatures[level] - 1.0 / temperatures[level + 1]) * (score_cold - score_hot);
+            if (exponent >= 0 || random.generateProbability() < std::exp(exponent)) {
+                std::swap(replica_at[level], replica_at[level + 1]);
+                _exchanges++;
+            }
+        }
+
+        for (const auto& replica : replicas) {
+            if (replica->best_score < best_score) {
+                best_score = replica->best_score;
+                best_epoch = epoch + 1;
+                _stop.reportScore(best_score);
+            }
+        }
+    }
+
+    if (_telemetry) {
+        sample(std::min(epoch * EXCHANGE_INTERVAL, _max_iterations));
+    }
+
+    // take the best replica, the first one wins among equal scores
+    size_t best = 0;
+    _total_iterations = 0;
+    _good_iterations = 0;
+    for (size_t r = 0; r < _num_replicas; r++) {
+        _total_iterations += replicas[r]->total_iterations;
+        _good_iterations += replicas[r]->good_iterations;
+        if (replicas[r]->best_score < replicas[best]->best_score) {
+            best = r;
+        }
+    }
+
+    _schedule = replicas[best]->bestSchedule();
+    return replicas[best]->best_score;
+}
@@ -0,0 +1,94 @@
+#pragma once
+#include <memory>
+#include <vector>
+
+#include "moves.h"
+#include "random.h"
+#include "schedule.h"
+#include "stop_condition.h"
+#include "telemetry.h"
+
+//
+// class TemperingOptimizer - parallel tempering (replica exchange).
+// Runs copies of the schedule at a ladder of fixed temperatures on worker threads.
+// Every exchange interval, replicas at neighbour temperatures swap
+// with probability min(1, exp((1/T_i - 1/T_j) * (E_i - E_j))),
+// so good schedules cool down while bad ones heat up and escape local minima.
+// Number of replicas does not depend on the number of threads,
+// so the result is reproducible from the seed.
+// The best schedule of all replicas is left in place, StopCondition
+// is checked between exchanges.
+// With telemetry the counters of all replicas and the score of the coldest one
+// are sampled to the trace between exchanges, iterations are counted per replica.
+//
+class TemperingOptimizer
+{
+public:
+    typedef MoveTarget Target;
+
+public:
+    TemperingOptimizer(
+        Schedule& schedule,
+        size_t max_iterations,
+        Target target,
+        const MoveWeights& weights,
+        size_t num_replicas,
+        size_t num_threads,
+        uint64_t seed,
+        const StopCondition& stop,
+        StageTelemetry* telemetry)
+        : _schedule(schedule)
+        , _max_iterations(max_iterations)
+        , _target(target)
+        , _weights(weights)
+        , _num_replicas(num_replicas)
+        , _num_threads(num_threads)
+        , _seed(seed)
+        , _stop(stop)
+        , _telemetry(telemetry)
+        , _total_iterations(0)
+        , _good_iterations(0)
+        , _exchanges(0)
+    {}
+
+public:
+    double optimize();
+
+    // iterations of all replicas
+    size_t totalIterations() const
+    {
+        return _total_iterations;
+    }
+
+    size_t goodIterations() const
+    {
+        return _good_iterations;
+    }
+
+    // number of accepted replica exchanges
+    size_t exchanges() const
+    {
+        return _exchanges;
+    }
+
+private:
+    template <typename Moves>
+    double temper();
+
+private:
+    Schedule& _schedule;
+
+    // iterations of every replica
+    size_t _max_iterations;
+    Target _target;
+    MoveWeights _weights;
+    size_t _num_replicas;
+    size_t _num_threads;
+    uint64_t _seed;
+    const StopCondition& _stop;
+    StageTelemetry* _telemetry;
+
+    size_t _total_iterations;
+    size_t _good_iterations;
+    size_t _exchanges;
+};
@@ -0,0 +1,71 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t num_threads)
+    : _num_tasks(0)
+    , _next_task(0)
+    , _busy_workers(0)
+    , _batch(0)
+    , _stop(false)
+{
+    if (num_threads == 0) {
+        num_threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (size_t worker = 0; worker < num_threads; worker++) {
+        _threads.emplace_back(&ThreadPool::workerLoop, this, worker);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _stop = true;
+    }
+    _start.notify_all();
+
+    for (auto& thread : _threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::run(size_t num_tasks, TaskFn fn)
+{
+    std::unique_lock<std::mutex> lock(_mutex);
+    _fn = fn;
+    _num_tasks = num_tasks;
+    _next_task = 0;
+    _busy_workers = _threads.size();
+    _batch++;
+    _start.notify_all();
+
+    _finish.wait(lock, [this]() { return _busy_workers == 0; });
+    _fn = nullptr;
+}
+
+void ThreadPool::workerLoop(size_t worker)
+{
+    size_t batch = 0;
+    std::unique_lock<std::mutex> lock(_mutex);
+    while (true) {
+        _start.wait(lock, [&]() { return _stop || _batch != batch; });
+        if (_stop) {
+            return;
+        }
+        batch = _batch;
+
+        // take tasks one by one, so long stages do not block short ones
+        while (_next_task < _num_tasks) {
+            size_t task = _next_task++;
+            lock.unlock();
+            _fn(task, worker);
+            lock.lock();
+        }
+
+        if (--_busy_workers == 0) {
+            _finish.notify_one();
+        }
+    }
+}
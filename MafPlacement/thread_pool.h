@@ -0,0 +1,52 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//
+// class ThreadPool - a fixed set of worker threads
+// which process a batch of independent tasks.
+//
+class ThreadPool
+{
+public:
+    // task function: task index, worker index
+    typedef std::function<void(size_t, size_t)> TaskFn;
+
+public:
+    // creates a pool, zero number of threads means all hardware threads
+    ThreadPool(size_t num_threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+public:
+    size_t numThreads() const
+    {
+        return _threads.size();
+    }
+
+    // runs tasks [0, num_tasks) on worker threads and waits until all of them finish
+    void run(size_t num_tasks, TaskFn fn);
+
+private:
+    void workerLoop(size_t worker);
+
+private:
+    std::vector<std::thread> _threads;
+
+    std::mutex _mutex;
+    std::condition_variable _start;
+    std::condition_variable _finish;
+
+    // current batch
+    TaskFn _fn;
+    size_t _num_tasks;
+    size_t _next_task;
+    size_t _busy_workers;
+    size_t _batch;
+    bool _stop;
+};
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+
+#include "types.h"
+
+// --------------------------------------------------------------------------
+// Zobrist hashing of schedules.
+// Keys are generated on the fly by a 64-bit mixer instead of a random table,
+// so any number of players and games is supported without memory.
+// --------------------------------------------------------------------------
+
+inline uint64_t zobristMix(uint64_t x)
+{
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// key of a player sitting at a seat of a game
+inline uint64_t zobristSeatKey(size_t seat, player_t player)
+{
+    return zobristMix((static_cast<uint64_t>(seat) << 16 | player) + 0x9e3779b97f4a7c15ULL);
+}
+
+// key of a game with given hash at given position in a schedule
+inline uint64_t zobristGameKey(size_t game_idx, uint64_t game_hash)
+{
+    return zobristMix(game_hash ^ zobristMix(game_idx + 0x632be59bd9b4e019ULL));
+}